@@ -0,0 +1,414 @@
+#include "analyse.h"
+#include "census.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+  // objects with a bounding box wider or taller than this aren't evolved
+  constexpr int32_t g_max_object_size = 32;
+
+  // live cells [begin_, end_) of row y_ (with gaps narrower than the analysis
+  // gap filled in, as they're one object anyway)
+  struct run_t {
+    int32_t begin_;
+    int32_t end_;
+    int32_t y_;
+  };
+
+  // runs of rows [first_row_, last_row_), run indices start at base_
+  struct band_t {
+    int32_t first_row_ = 0;
+    int32_t last_row_ = 0;
+    std::vector<run_t> runs_;
+    std::vector<int64_t> row_starts_; // index into runs_ of each row's first
+    int64_t base_ = 0;
+  };
+
+  void find_runs(const bitboard_t& board, const int32_t gap, band_t& band) {
+    for (int32_t y = band.first_row_; y < band.last_row_; y++) {
+      band.row_starts_.push_back(int64_t(band.runs_.size()));
+      const std::span<const uint64_t> row = bitboard_row(board, y);
+      const size_t row_start = band.runs_.size();
+      for (int32_t word = 0; word < board.stride_; word++) {
+        uint64_t bits = row[word];
+        while (bits != 0) {
+          const int32_t start = std::countr_zero(bits);
+          const int32_t length = std::countr_one(bits >> start);
+          const int32_t begin = word * 64 + start;
+          if (
+            band.runs_.size() > row_start
+            && begin - band.runs_.back().end_ < gap) {
+            band.runs_.back().end_ = begin + length;
+          } else {
+            band.runs_.push_back({begin, begin + length, y});
+          }
+          bits = start + length >= 64
+                 ? 0
+                 : bits & (~uint64_t(0) << (start + length));
+        }
+      }
+    }
+    band.row_starts_.push_back(int64_t(band.runs_.size()));
+  }
+
+  int64_t find_root(std::vector<int64_t>& parents, int64_t run) {
+    while (parents[run] != run) {
+      parents[run] = parents[parents[run]]; // path halving
+      run = parents[run];
+    }
+    return run;
+  }
+
+  void unite(std::vector<int64_t>& parents, int64_t lhs, int64_t rhs) {
+    lhs = find_root(parents, lhs);
+    rhs = find_root(parents, rhs);
+    if (lhs != rhs) {
+      parents[std::max(lhs, rhs)] = std::min(lhs, rhs);
+    }
+  }
+
+  // joins the runs of two rows that come within gap of each other, both
+  // sorted so a sweep finds every pair
+  void unite_rows(
+    std::vector<int64_t>& parents, const std::vector<run_t>& runs,
+    int64_t upper, const int64_t upper_end, int64_t lower,
+    const int64_t lower_end, const int32_t gap) {
+    while (upper < upper_end && lower < lower_end) {
+      const run_t& a = runs[upper];
+      const run_t& b = runs[lower];
+      if (b.begin_ < a.end_ + gap && a.begin_ < b.end_ + gap) {
+        unite(parents, upper, lower);
+      }
+      if (a.end_ < b.end_) {
+        upper++;
+      } else {
+        lower++;
+      }
+    }
+  }
+
+  // the run of row y holding cell x, which is live so is in one
+  int64_t find_run(
+    const std::vector<run_t>& runs, const std::vector<int64_t>& row_starts,
+    const int32_t x, const int32_t y) {
+    const auto run = std::upper_bound(
+      runs.begin() + row_starts[y], runs.begin() + row_starts[y + 1], x,
+      [](const int32_t x, const run_t& run) { return x < run.begin_; });
+    return int64_t(run - runs.begin()) - 1;
+  }
+
+  // moves (x, y) from past an edge to the cell it joins to, rows first then
+  // the sides of the row landed on as fill_halo joins them, false in the
+  // plane's dead space or further than a board away
+  bool join_cell(
+    const bitboard_t& board, const topology_e topology, int32_t& x,
+    int32_t& y) {
+    if (y < 0 || y >= board.height_) {
+      if (topology == topology_e::plane) {
+        return false;
+      }
+      y = y < 0 ? y + board.height_ : y - board.height_;
+      if (topology != topology_e::torus) {
+        x = board.width_ - 1 - x;
+      }
+    }
+    if (x < 0 || x >= board.width_) {
+      if (topology == topology_e::plane) {
+        return false;
+      }
+      x = x < 0 ? x + board.width_ : x - board.width_;
+      if (topology == topology_e::cross_surface) {
+        y = board.height_ - 1 - y;
+      }
+    }
+    return x >= 0 && x < board.width_ && y >= 0 && y < board.height_;
+  }
+
+  // the cells of an object crossing a joined edge, walked out from seed with
+  // coordinates kept unwrapped (as find_objects does) so it comes out whole,
+  // empty once it's bigger than g_max_object_size
+  std::vector<cell_t> unwrapped_cells(
+    const bitboard_t& board, const topology_e topology, const int32_t gap,
+    const cell_t seed) {
+    std::vector<cell_t> cells;
+    std::unordered_set<int64_t> visited = {
+      int64_t(seed.y) * board.width_ + seed.x};
+    std::vector<cell_t> stack = {seed};
+    cell_t min = seed;
+    cell_t max = seed;
+    while (!stack.empty()) {
+      const cell_t cell = stack.back();
+      stack.pop_back();
+      cells.push_back(cell);
+      min = {std::min(min.x, cell.x), std::min(min.y, cell.y)};
+      max = {std::max(max.x, cell.x), std::max(max.y, cell.y)};
+      if (
+        max.x - min.x >= g_max_object_size
+        || max.y - min.y >= g_max_object_size) {
+        return {};
+      }
+      for (int32_t dy = -gap; dy <= gap; dy++) {
+        for (int32_t dx = -gap; dx <= gap; dx++) {
+          int32_t x = cell.x + dx;
+          int32_t y = cell.y + dy;
+          if (
+            join_cell(board, topology, x, y) && bitboard_cell(board, x, y)
+            && visited.insert(int64_t(y) * board.width_ + x).second) {
+            stack.push_back({cell.x + dx, cell.y + dy});
+          }
+        }
+      }
+    }
+    return cells;
+  }
+
+} // namespace
+
+analyse_result_t analyse_board(
+  const bitboard_t& board, const analyse_options_t& options) {
+  analyse_result_t result;
+  const auto begin = std::chrono::steady_clock::now();
+  const int32_t gap = std::max(options.gap_, 1);
+  const int32_t thread_count = std::clamp(
+    options.threads_ > 0
+      ? options.threads_
+      : int32_t(std::thread::hardware_concurrency()),
+    1, std::max(board.height_, 1));
+  const auto run_threads = [thread_count](const auto& work) {
+    std::vector<std::thread> threads;
+    for (int32_t thread = 1; thread < thread_count; thread++) {
+      threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  };
+
+  // runs are found a band at a time then gathered into one array
+  std::vector<band_t> bands(thread_count);
+  run_threads([&](const int32_t thread) {
+    band_t& band = bands[thread];
+    band.first_row_ = int32_t(int64_t(board.height_) * thread / thread_count);
+    band.last_row_ =
+      int32_t(int64_t(board.height_) * (thread + 1) / thread_count);
+    find_runs(board, gap, band);
+  });
+  std::vector<run_t> runs;
+  std::vector<int64_t> row_starts;
+  for (band_t& band : bands) {
+    band.base_ = int64_t(runs.size());
+    runs.insert(runs.end(), band.runs_.begin(), band.runs_.end());
+    for (size_t row = 0; row + 1 < band.row_starts_.size(); row++) {
+      row_starts.push_back(band.base_ + band.row_starts_[row]);
+    }
+    band.runs_ = {};
+  }
+  row_starts.push_back(int64_t(runs.size()));
+
+  // each band joins the rows within it (so touches only its own runs), then
+  // the rows reaching across the seams between bands are joined
+  std::vector<int64_t> parents(runs.size());
+  for (size_t run = 0; run < runs.size(); run++) {
+    parents[run] = int64_t(run);
+  }
+  const auto unite_band = [&](const int32_t first, const int32_t last) {
+    for (int32_t y = first; y < last; y++) {
+      for (int32_t other = y + 1; other < std::min(y + gap + 1, last);
+           other++) {
+        unite_rows(
+          parents, runs, row_starts[y], row_starts[y + 1], row_starts[other],
+          row_starts[other + 1], gap);
+      }
+    }
+  };
+  run_threads([&](const int32_t thread) {
+    unite_band(bands[thread].first_row_, bands[thread].last_row_);
+  });
+  for (int32_t thread = 1; thread < thread_count; thread++) {
+    const int32_t seam = bands[thread].first_row_;
+    for (int32_t y = std::max(seam - gap, 0); y < seam; y++) {
+      for (int32_t other = seam;
+           other < std::min(y + gap + 1, board.height_); other++) {
+        unite_rows(
+          parents, runs, row_starts[y], row_starts[y + 1], row_starts[other],
+          row_starts[other + 1], gap);
+      }
+    }
+  }
+
+  // live cells within gap of a joined edge are joined to the cells within gap
+  // of them across it, the runs they join are remembered so the objects they
+  // belong to can be walked out whole
+  std::vector<int64_t> joined;
+  const auto join_edges = [&](const int32_t x, const int32_t y) {
+    for (int32_t dy = -gap; dy <= gap; dy++) {
+      for (int32_t dx = -gap; dx <= gap; dx++) {
+        int32_t other_x = x + dx;
+        int32_t other_y = y + dy;
+        if (
+          (other_x >= 0 && other_x < board.width_ && other_y >= 0
+           && other_y < board.height_)
+          || !join_cell(board, options.topology_, other_x, other_y)
+          || !bitboard_cell(board, other_x, other_y)) {
+          continue;
+        }
+        const int64_t run = find_run(runs, row_starts, x, y);
+        unite(parents, run, find_run(runs, row_starts, other_x, other_y));
+        joined.push_back(run);
+      }
+    }
+  };
+  if (options.topology_ != topology_e::plane) {
+    for (int32_t y = 0; y < board.height_; y++) {
+      if (y < gap || y >= board.height_ - gap) {
+        const std::span<const uint64_t> row = bitboard_row(board, y);
+        for (int32_t word = 0; word < board.stride_; word++) {
+          for (uint64_t bits = row[word]; bits != 0; bits &= bits - 1) {
+            join_edges(word * 64 + std::countr_zero(bits), y);
+          }
+        }
+        continue;
+      }
+      for (int32_t x = 0; x < board.width_; x++) {
+        if (x == gap && x < board.width_ - gap) {
+          x = board.width_ - gap; // only the sides
+        }
+        if (bitboard_cell(board, x, y)) {
+          join_edges(x, y);
+        }
+      }
+    }
+  }
+
+  // roots are the lowest run of each object, so objects come out in order of
+  // their first row
+  std::vector<int64_t> objects(runs.size(), -1);
+  std::vector<int64_t> roots; // of each object
+  struct extent_t {
+    int32_t min_x = INT32_MAX;
+    int32_t min_y = INT32_MAX;
+    int32_t max_x = INT32_MIN;
+    int32_t max_y = INT32_MIN;
+  };
+  std::vector<extent_t> extents;
+  for (size_t run = 0; run < runs.size(); run++) {
+    const int64_t root = find_root(parents, int64_t(run));
+    if (objects[root] < 0) {
+      objects[root] = int64_t(extents.size());
+      extents.emplace_back();
+      roots.push_back(root);
+    }
+    objects[run] = objects[root];
+    extent_t& extent = extents[objects[run]];
+    extent.min_x = std::min(extent.min_x, runs[run].begin_);
+    extent.max_x = std::max(extent.max_x, runs[run].end_ - 1);
+    extent.min_y = std::min(extent.min_y, runs[run].y_);
+    extent.max_y = std::max(extent.max_y, runs[run].y_);
+  }
+  result.objects_ = int64_t(extents.size());
+  result.label_seconds_ = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - begin)
+                            .count();
+
+  // the cells of objects small enough to classify (runs hold filled in gaps,
+  // so cells are read back from the board), objects joined across an edge are
+  // walked out from the first cell of their root instead
+  std::vector<std::vector<cell_t>> cells(extents.size());
+  std::vector<uint8_t> wrapped(extents.size());
+  for (const int64_t run : joined) {
+    wrapped[objects[run]] = 1;
+  }
+  for (size_t object = 0; object < extents.size(); object++) {
+    if (wrapped[object]) {
+      const run_t& root = runs[roots[object]];
+      cells[object] = unwrapped_cells(
+        board, options.topology_, gap, {root.begin_, root.y_});
+    }
+  }
+  for (size_t run = 0; run < runs.size(); run++) {
+    const extent_t& extent = extents[objects[run]];
+    if (
+      wrapped[objects[run]] || extent.max_x - extent.min_x >= g_max_object_size
+      || extent.max_y - extent.min_y >= g_max_object_size) {
+      continue;
+    }
+    for (int32_t x = runs[run].begin_; x < runs[run].end_; x++) {
+      if (bitboard_cell(board, x, runs[run].y_)) {
+        cells[objects[run]].push_back({x, runs[run].y_});
+      }
+    }
+  }
+
+  // objects are grouped by their shape, then the shapes by their canonical
+  // code so each is classified once whatever its orientation
+  struct shape_t {
+    int64_t count_ = 0;
+    size_t object_ = 0; // the first object with the shape
+  };
+  std::unordered_map<std::string, shape_t> shapes;
+  for (size_t object = 0; object < cells.size(); object++) {
+    if (cells[object].empty()) {
+      result.large_++;
+    } else if (shape_t& shape = shapes[normalized_code(cells[object])];
+               shape.count_++ == 0) {
+      shape.object_ = object;
+    }
+  }
+  std::unordered_map<std::string, shape_t> canonical;
+  for (const auto& [code, shape] : shapes) {
+    shape_t& oriented = canonical[canonical_code(cells[shape.object_])];
+    if (oriented.count_ == 0) {
+      oriented.object_ = shape.object_;
+    }
+    oriented.count_ += shape.count_;
+  }
+
+  // the most common shapes are classified, spread over the threads
+  std::vector<const shape_t*> unique;
+  for (const auto& [code, shape] : canonical) {
+    unique.push_back(&shape);
+  }
+  std::sort(
+    unique.begin(), unique.end(), [](const shape_t* lhs, const shape_t* rhs) {
+      return lhs->count_ != rhs->count_ ? lhs->count_ > rhs->count_
+                                        : lhs->object_ < rhs->object_;
+    });
+  const size_t classified =
+    std::min(unique.size(), size_t(std::max(options.max_shapes_, 0)));
+  for (size_t shape = classified; shape < unique.size(); shape++) {
+    result.unclassified_ += unique[shape]->count_;
+  }
+  std::vector<std::string> names(classified);
+  std::atomic<size_t> next_shape = 0;
+  run_threads([&](int32_t) {
+    for (size_t shape = next_shape++; shape < classified;
+         shape = next_shape++) {
+      names[shape] = classify_object(cells[unique[shape]->object_]).name_;
+    }
+  });
+  for (size_t shape = 0; shape < classified; shape++) {
+    result.counts_[names[shape]] += unique[shape]->count_;
+  }
+  if (result.unclassified_ > 0) {
+    result.counts_["unclassified"] += result.unclassified_;
+  }
+  if (result.large_ > 0) {
+    result.counts_["large"] += result.large_;
+  }
+
+  result.seconds_ = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+  return result;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "bitboard.h"
+#include "topology.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+struct analyse_options_t {
+  // live cells up to this many cells apart (in any direction) belong to the
+  // same object, 1 for plain 8-connectivity
+  int32_t gap_ = 1;
+  // how the board's edges join (the engine's topology_), an object crossing a
+  // joined edge is one object
+  topology_e topology_ = topology_e::torus;
+  // distinct shapes classified per call, the most common first, objects of
+  // the rest are counted as "unclassified"
+  int32_t max_shapes_ = 256;
+  int32_t threads_ = 0; // 0 to use every core
+};
+
+struct analyse_result_t {
+  std::map<std::string, int64_t> counts_; // by census_object_t::name_
+  int64_t objects_ = 0;
+  int64_t large_ = 0; // objects too big to classify (counted as "large")
+  int64_t unclassified_ = 0; // of shapes past max_shapes_
+  double label_seconds_ = 0.0; // splitting the board into objects
+  double seconds_ = 0.0; // including classifying each distinct shape
+};
+
+// splits the board into objects and names each with classify_object, once
+// per shape whatever its orientation. labelling is a union-find over the runs
+// of live cells in each row, with a band of rows per thread, then the cells
+// near joined edges are joined to those across them
+analyse_result_t analyse_board(
+  const bitboard_t& board, const analyse_options_t& options);
@@ -0,0 +1,359 @@
+#include "batch.h"
+#include "life_kernel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+  // generations between gathering the boards that are still running into as
+  // few groups as will hold them
+  constexpr int32_t g_epoch = 64;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  // two cells' words stepped together by life_lanes
+  struct wide_t {
+    __m128i words_;
+  };
+
+  inline wide_t operator&(const wide_t lhs, const wide_t rhs) {
+    return {_mm_and_si128(lhs.words_, rhs.words_)};
+  }
+
+  inline wide_t operator|(const wide_t lhs, const wide_t rhs) {
+    return {_mm_or_si128(lhs.words_, rhs.words_)};
+  }
+
+  inline wide_t operator^(const wide_t lhs, const wide_t rhs) {
+    return {_mm_xor_si128(lhs.words_, rhs.words_)};
+  }
+
+  inline wide_t operator~(const wide_t word) {
+    return {_mm_xor_si128(word.words_, _mm_set1_epi32(-1))};
+  }
+
+  inline wide_t load_wide(const uint64_t* words) {
+    return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(words))};
+  }
+
+  inline uint64_t fold_wide(const wide_t word) {
+    alignas(16) uint64_t words[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(words), word.words_);
+    return words[0] | words[1];
+  }
+#endif
+
+  // a group's cells with a one cell ghost border, filled as fill_halo does
+  // but a word per cell: cell (x, y) at (y + 1) * (width + 2) + x + 1. the
+  // border of the plane is left as it was (zero)
+  void fill_padded(
+    std::vector<uint64_t>& padded, const uint64_t* cells, const int32_t width,
+    const int32_t height, const topology_e topology) {
+    const int32_t stride = width + 2;
+    const bool mirror_sides = topology == topology_e::cross_surface;
+    for (int32_t y = 0; y < height; y++) {
+      uint64_t* row = padded.data() + (y + 1) * stride;
+      std::copy(cells + y * width, cells + (y + 1) * width, row + 1);
+      if (topology != topology_e::plane) {
+        const int32_t side = mirror_sides ? height - 1 - y : y;
+        row[0] = cells[side * width + width - 1];
+        row[width + 1] = cells[side * width];
+      }
+    }
+    if (topology == topology_e::plane) {
+      return;
+    }
+    const bool mirror_ends = topology != topology_e::torus;
+    const auto fill_ghost_row = [&](const int32_t ghost, const int32_t source) {
+      uint64_t* row = padded.data() + ghost * stride;
+      const uint64_t* from = padded.data() + source * stride;
+      for (int32_t x = 0; x < stride; x++) {
+        row[x] = from[mirror_ends ? stride - 1 - x : x];
+      }
+    };
+    fill_ghost_row(0, height);
+    fill_ghost_row(height + 1, 1);
+  }
+
+  // steps a row of a group from its padded row and the rows around it, and
+  // ors the lanes that changed since the last generation and the one before
+  // into changed and changed_before
+  void step_row(
+    const uint64_t* north, const uint64_t* row, const uint64_t* south,
+    const uint64_t* last, const uint64_t* before, uint64_t* next,
+    const int32_t width, uint64_t& changed, uint64_t& changed_before) {
+    int32_t x = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    wide_t wide_changed = {_mm_setzero_si128()};
+    wide_t wide_changed_before = {_mm_setzero_si128()};
+    for (; x + 2 <= width; x += 2) {
+      const wide_t cells = life_lanes(
+        load_wide(north + x), load_wide(north + x + 1),
+        load_wide(north + x + 2), load_wide(row + x), load_wide(row + x + 1),
+        load_wide(row + x + 2), load_wide(south + x), load_wide(south + x + 1),
+        load_wide(south + x + 2));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(next + x), cells.words_);
+      wide_changed = wide_changed | (cells ^ load_wide(last + x));
+      wide_changed_before =
+        wide_changed_before | (cells ^ load_wide(before + x));
+    }
+    changed |= fold_wide(wide_changed);
+    changed_before |= fold_wide(wide_changed_before);
+#endif
+    for (; x < width; x++) {
+      next[x] = life_lanes(
+        north[x], north[x + 1], north[x + 2], row[x], row[x + 1], row[x + 2],
+        south[x], south[x + 1], south[x + 2]);
+      changed |= next[x] ^ last[x];
+      changed_before |= next[x] ^ before[x];
+    }
+  }
+
+  // the boards still running packed into groups laid out as batch_t::cells_,
+  // lane l of group g is board boards_[g * 64 + l] (-1 for an empty lane)
+  struct packed_t {
+    int32_t groups_ = 0;
+    std::vector<uint64_t> last_; // the latest generation
+    std::vector<uint64_t> before_; // the one before it
+    std::vector<int32_t> boards_;
+    std::vector<int32_t> stopped_; // generation each group got to
+  };
+
+  // per thread buffers for stepping a group
+  struct scratch_t {
+    std::vector<uint64_t> padded_;
+    std::vector<uint64_t> boards_[3]; // rotated: before, last, next
+  };
+
+  // steps a group from generation `from` to `to`, stopping early once every
+  // board in it has settled, returns the generation it got to
+  int32_t step_group(
+    batch_t& batch, packed_t& packed, const int32_t group, const int32_t from,
+    const int32_t to, const topology_e topology, scratch_t& scratch) {
+    const int32_t width = batch.width_;
+    const int32_t height = batch.height_;
+    const int64_t cells = int64_t(width) * height;
+    const int32_t stride = width + 2;
+    uint64_t active = 0;
+    for (int32_t lane = 0; lane < 64; lane++) {
+      const int32_t board = packed.boards_[group * 64 + lane];
+      if (board >= 0 && batch.settled_[board] < 0) {
+        active |= uint64_t(1) << lane;
+      }
+    }
+    if (active == 0) {
+      return from;
+    }
+
+    scratch.padded_.resize(size_t(stride) * (height + 2));
+    for (std::vector<uint64_t>& board : scratch.boards_) {
+      board.resize(cells);
+    }
+    uint64_t* group_last = packed.last_.data() + group * cells;
+    uint64_t* group_before = packed.before_.data() + group * cells;
+    uint64_t* before = scratch.boards_[0].data();
+    uint64_t* last = scratch.boards_[1].data();
+    uint64_t* next = scratch.boards_[2].data();
+    std::copy(group_before, group_before + cells, before);
+    std::copy(group_last, group_last + cells, last);
+
+    int32_t generation = from;
+    while (generation < to && active != 0) {
+      generation++;
+      fill_padded(scratch.padded_, last, width, height, topology);
+      uint64_t changed = 0;
+      uint64_t changed_before = 0;
+      for (int32_t y = 0; y < height; y++) {
+        const uint64_t* north = scratch.padded_.data() + y * stride;
+        step_row(
+          north, north + stride, north + 2 * stride, last + y * width,
+          before + y * width, next + y * width, width, changed,
+          changed_before);
+      }
+      uint64_t settled = ~changed;
+      if (generation >= 2) {
+        settled |= ~changed_before;
+      }
+      for (uint64_t lanes = settled & active; lanes != 0;
+           lanes &= lanes - 1) {
+        batch.settled_[packed.boards_[group * 64 + std::countr_zero(lanes)]] =
+          generation;
+      }
+      active &= ~settled;
+      uint64_t* const oldest = before;
+      before = last;
+      last = next;
+      next = oldest;
+    }
+
+    std::copy(before, before + cells, group_before);
+    std::copy(last, last + cells, group_last);
+    return generation;
+  }
+
+  void copy_lane(
+    uint64_t* to, const int32_t to_lane, const uint64_t* from,
+    const int32_t from_lane, const int64_t cells) {
+    const uint64_t mask = uint64_t(1) << to_lane;
+    for (int64_t cell = 0; cell < cells; cell++) {
+      const uint64_t bit = (from[cell] >> from_lane) & 1;
+      to[cell] = (to[cell] & ~mask) | (bit << to_lane);
+    }
+  }
+
+  // moves the running boards (those not yet written back) into the first
+  // groups, in order
+  void repack(packed_t& packed, const int32_t running, const int64_t cells) {
+    packed_t repacked;
+    repacked.groups_ = (running + 63) / 64;
+    repacked.last_.assign(size_t(repacked.groups_) * cells, uint64_t(0));
+    repacked.before_.assign(size_t(repacked.groups_) * cells, uint64_t(0));
+    repacked.boards_.assign(size_t(repacked.groups_) * 64, -1);
+    repacked.stopped_.assign(repacked.groups_, 0);
+    int32_t index = 0;
+    for (size_t lane = 0; lane < packed.boards_.size(); lane++) {
+      if (packed.boards_[lane] < 0) {
+        continue;
+      }
+      const int64_t from = int64_t(lane / 64) * cells;
+      const int64_t to = int64_t(index / 64) * cells;
+      copy_lane(
+        repacked.last_.data() + to, index % 64, packed.last_.data() + from,
+        int32_t(lane % 64), cells);
+      copy_lane(
+        repacked.before_.data() + to, index % 64,
+        packed.before_.data() + from, int32_t(lane % 64), cells);
+      repacked.boards_[index++] = packed.boards_[lane];
+    }
+    packed = std::move(repacked);
+  }
+
+} // namespace
+
+batch_t make_batch(
+  const int32_t width, const int32_t height, const int32_t count) {
+  batch_t batch;
+  batch.width_ = width;
+  batch.height_ = height;
+  batch.count_ = count;
+  batch.groups_ = (count + 63) / 64;
+  batch.cells_.assign(size_t(batch.groups_) * width * height, uint64_t(0));
+  batch.settled_.assign(count, -1);
+  return batch;
+}
+
+void set_batch_board(
+  batch_t& batch, const int32_t index, const bitboard_t& board) {
+  uint64_t* cells =
+    batch.cells_.data() + int64_t(index / 64) * batch.width_ * batch.height_;
+  const uint64_t lane = uint64_t(1) << (index % 64);
+  for (int32_t y = 0; y < batch.height_; y++) {
+    for (int32_t x = 0; x < batch.width_; x++) {
+      uint64_t& cell = cells[y * batch.width_ + x];
+      cell = bitboard_cell(board, x, y) ? cell | lane : cell & ~lane;
+    }
+  }
+  batch.settled_[index] = -1;
+}
+
+bitboard_t batch_board(const batch_t& batch, const int32_t index) {
+  bitboard_t board = make_bitboard(batch.width_, batch.height_);
+  const uint64_t* cells =
+    batch.cells_.data() + int64_t(index / 64) * batch.width_ * batch.height_;
+  for (int32_t y = 0; y < batch.height_; y++) {
+    for (int32_t x = 0; x < batch.width_; x++) {
+      set_bitboard_cell(
+        board, x, y, (cells[y * batch.width_ + x] >> (index % 64)) & 1);
+    }
+  }
+  return board;
+}
+
+batch_stats_t step_batch(batch_t& batch, const batch_options_t& options) {
+  batch_stats_t stats;
+  const auto begin = std::chrono::steady_clock::now();
+  const int64_t cells = int64_t(batch.width_) * batch.height_;
+  const int32_t generations = std::max(options.generations_, 0);
+
+  packed_t packed;
+  packed.groups_ = batch.groups_;
+  packed.last_ = batch.cells_;
+  packed.before_ = batch.cells_; // not compared until generation 2
+  packed.boards_.assign(size_t(batch.groups_) * 64, -1);
+  for (int32_t board = 0; board < batch.count_; board++) {
+    packed.boards_[board] = board;
+  }
+  packed.stopped_.assign(packed.groups_, 0);
+
+  const int32_t thread_count = std::min(
+    options.threads_ > 0
+      ? options.threads_
+      : std::max(int32_t(std::thread::hardware_concurrency()), 1),
+    std::max(batch.groups_, 1));
+  int32_t generation = 0;
+  while (packed.groups_ > 0) {
+    const int32_t to = std::min(generation + g_epoch, generations);
+    std::atomic<int32_t> next_group = 0;
+    std::atomic<int64_t> group_generations = 0;
+    const auto worker = [&] {
+      scratch_t scratch;
+      for (int32_t group = next_group++; group < packed.groups_;
+           group = next_group++) {
+        packed.stopped_[group] = step_group(
+          batch, packed, group, generation, to, options.topology_, scratch);
+        group_generations += packed.stopped_[group] - generation;
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int32_t thread = 1;
+         thread < std::min(thread_count, packed.groups_); thread++) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    stats.group_generations_ += group_generations;
+    generation = to;
+
+    // settled boards repeat with period 1 or 2, so their final board is one
+    // of the last two generations their group got to by parity
+    int32_t running = 0;
+    for (size_t lane = 0; lane < packed.boards_.size(); lane++) {
+      const int32_t board = packed.boards_[lane];
+      if (board < 0) {
+        continue;
+      }
+      if (batch.settled_[board] < 0 && generation < generations) {
+        running++;
+        continue;
+      }
+      const int32_t group = int32_t(lane / 64);
+      const int32_t stopped = packed.stopped_[group];
+      const std::vector<uint64_t>& final_cells =
+        (generations - stopped) % 2 == 0 ? packed.last_ : packed.before_;
+      copy_lane(
+        batch.cells_.data() + int64_t(board / 64) * cells, board % 64,
+        final_cells.data() + group * cells, int32_t(lane % 64), cells);
+      packed.boards_[lane] = -1;
+    }
+    if (running == 0) {
+      break;
+    }
+    if ((running + 63) / 64 < packed.groups_) {
+      repack(packed, running, cells);
+    }
+  }
+
+  stats.seconds_ = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - begin)
+                     .count();
+  return stats;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "bitboard.h"
+#include "topology.h"
+
+#include <cstdint>
+#include <vector>
+
+// many boards of the same size stepped in lockstep, a board to each bit lane:
+// bit b of a cell's word in group g is that cell on board g * 64 + b, and each
+// group's words are laid out a row at a time like a board of words
+struct batch_t {
+  int32_t width_ = 0;
+  int32_t height_ = 0;
+  int32_t count_ = 0; // boards
+  int32_t groups_ = 0; // of 64 boards, the last may be partly empty
+  std::vector<uint64_t> cells_; // cell (x, y) of group g at (g * h + y) * w + x
+  // the generation each board first matched its board one or two generations
+  // before (so is still or a blinker ash from then on), -1 until it does
+  std::vector<int32_t> settled_;
+};
+
+batch_t make_batch(int32_t width, int32_t height, int32_t count);
+
+void set_batch_board(batch_t& batch, int32_t index, const bitboard_t& board);
+bitboard_t batch_board(const batch_t& batch, int32_t index);
+
+struct batch_options_t {
+  int32_t generations_ = 1000;
+  topology_e topology_ = topology_e::torus;
+  int32_t threads_ = 0; // 0 to use every core
+};
+
+struct batch_stats_t {
+  int64_t group_generations_ = 0; // stepped, of groups_ * generations_
+  double seconds_ = 0.0;
+};
+
+// advances every board options.generations_, a group of 64 per pass of the
+// kernel with groups spread over the threads. boards that settle drop out
+// (their final boards are picked from the last two generations by parity)
+// and every 64 generations the rest are packed into as few groups as hold them
+batch_stats_t step_batch(batch_t& batch, const batch_options_t& options);
@@ -0,0 +1,156 @@
+#include "bench.h"
+#include "fixed_board.h"
+#include "random.h"
+#include "soup.h"
+#include "sparse.h"
+
+#include <chrono>
+
+namespace {
+
+  // a soup too big to hold densely, its live cells picked at random
+  std::vector<bench_result_t> run_sparse_bench(const bench_options_t& options) {
+    sparse_board_t board = make_sparse_board(
+      options.width_, options.height_, engine_t().topology_);
+    xoshiro256_t rng = make_xoshiro256(options.seed_);
+    const auto population = int64_t(
+      options.density_ * double(options.width_) * double(options.height_));
+    for (int64_t cell = 0; cell < population; cell++) {
+      set_sparse_cell(
+        board, int32_t(xoshiro256_next(rng) % uint64_t(options.width_)),
+        int32_t(xoshiro256_next(rng) % uint64_t(options.height_)), true);
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    for (int32_t generation = 0; generation < options.generations_;
+         generation++) {
+      step_sparse(board);
+    }
+    return {
+      {.engine_ = engine_e::sparse,
+       .seconds_ = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - begin)
+                     .count(),
+       .hash_ = sparse_hash(board)}};
+  }
+
+  constexpr int32_t g_small_width = 40;
+  constexpr int32_t g_small_height = 27;
+
+  // a blinker turns on the spot, checked at compile time
+  constexpr bool blinker_turns() {
+    fixed_board_t<5, 5> board;
+    for (int32_t x = 1; x < 4; x++) {
+      set_fixed_cell(board, x, 2, true);
+    }
+    step_fixed(board);
+    return fixed_cell(board, 2, 1) && fixed_cell(board, 2, 3)
+        && !fixed_cell(board, 1, 2) && !fixed_cell(board, 3, 2);
+  }
+  static_assert(blinker_turns());
+
+} // namespace
+
+std::vector<bench_result_t> run_bench(const bench_options_t& options) {
+  if (double(options.width_) * double(options.height_) > dense_bench_cells) {
+    return run_sparse_bench(options);
+  }
+  bitboard_t soup = make_bitboard(options.width_, options.height_);
+  fill_soup(soup, {.density_ = options.density_, .seed_ = options.seed_});
+
+  std::vector<bench_result_t> results;
+  for (int32_t kind = 0; kind < int32_t(engine_e::count); kind++) {
+    engine_t engine;
+    engine.kind_ = engine_e(kind);
+    bitboard_t board = soup;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int32_t generation = 0; generation < options.generations_;
+         generation++) {
+      step_engine(engine, board);
+    }
+    results.push_back(
+      {.engine_ = engine.kind_,
+       .seconds_ = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - begin)
+                     .count(),
+       .hash_ = bitboard_hash(board)});
+    destroy_engine(engine);
+  }
+  return results;
+}
+
+std::vector<small_bench_result_t> run_small_bench(
+  const bench_options_t& options) {
+  bitboard_t soup = make_bitboard(g_small_width, g_small_height);
+  fill_soup(soup, {.density_ = options.density_, .seed_ = options.seed_});
+  const auto seconds_since = [](const auto begin) {
+    return std::chrono::duration<double>(
+             std::chrono::steady_clock::now() - begin)
+      .count();
+  };
+
+  std::vector<small_bench_result_t> results;
+  for (const engine_e kind : {engine_e::reference, engine_e::lut}) {
+    engine_t engine;
+    engine.kind_ = kind;
+    bitboard_t board = soup;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int32_t generation = 0; generation < options.generations_;
+         generation++) {
+      step_engine(engine, board);
+    }
+    results.push_back(
+      {.name_ = engine_name(kind),
+       .seconds_ = seconds_since(begin),
+       .hash_ = bitboard_hash(board)});
+    destroy_engine(engine);
+  }
+
+  fixed_board_t<g_small_width, g_small_height> board;
+  fixed_from_bitboard(board, soup);
+  const auto begin = std::chrono::steady_clock::now();
+  for (int32_t generation = 0; generation < options.generations_;
+       generation++) {
+    step_fixed(board);
+  }
+  results.push_back(
+    {.name_ = "Fixed size",
+     .seconds_ = seconds_since(begin),
+     .hash_ = bitboard_hash(fixed_to_bitboard(board))});
+  return results;
+}
+
+std::vector<blocked_bench_result_t> run_blocked_bench(
+  const bench_options_t& options, const int32_t max_depth,
+  const int32_t threads) {
+  bitboard_t soup = make_bitboard(options.width_, options.height_);
+  fill_soup(soup, {.density_ = options.density_, .seed_ = options.seed_});
+
+  std::vector<blocked_bench_result_t> results;
+  {
+    engine_t engine;
+    bitboard_t board = soup;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int32_t generation = 0; generation < options.generations_;
+         generation++) {
+      step_engine(engine, board);
+    }
+    blocked_bench_result_t result;
+    result.stats_.seconds_ = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - begin)
+                               .count();
+    result.hash_ = bitboard_hash(board);
+    results.push_back(result);
+    destroy_engine(engine);
+  }
+  for (int32_t depth = 1; depth <= max_depth; depth++) {
+    bitboard_t board = soup;
+    blocked_bench_result_t result;
+    result.depth_ = depth;
+    result.stats_ = step_blocked(
+      board, engine_t().topology_, options.generations_,
+      {.depth_ = depth, .threads_ = threads});
+    result.hash_ = bitboard_hash(board);
+    results.push_back(result);
+  }
+  return results;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "blocked.h"
+#include "engine.h"
+
+#include <cstdint>
+#include <vector>
+
+struct bench_options_t {
+  int32_t width_ = 1024;
+  int32_t height_ = 1024;
+  int32_t generations_ = 100;
+  double density_ = 0.35;
+  uint64_t seed_ = 1;
+};
+
+struct bench_result_t {
+  engine_e engine_;
+  double seconds_ = 0.0;
+  uint64_t hash_ = 0; // of the board after the last generation
+};
+
+// boards with more cells than this are only stepped by the sparse engine,
+// their soups are picked a live cell at a time so the default density is far
+// lower and a soup of more than max_sparse_bench_cells isn't held at all
+constexpr double dense_bench_cells = double(1 << 30);
+constexpr double sparse_bench_density = 0.000001;
+constexpr int64_t max_sparse_bench_cells = int64_t(1) << 22;
+
+// steps the same random soup with every engine, or only the sparse engine for
+// boards over dense_bench_cells
+std::vector<bench_result_t> run_bench(const bench_options_t& options);
+
+// the board size the window uses (40x27), small enough that per generation
+// overhead dominates
+struct small_bench_result_t {
+  const char* name_;
+  double seconds_ = 0.0;
+  uint64_t hash_ = 0;
+};
+
+// steps a soup of the window's size on the torus with mc_gol_update_board,
+// the lookup table engine and as a fixed_board_t (the width and height of the
+// options are ignored)
+std::vector<small_bench_result_t> run_small_bench(
+  const bench_options_t& options);
+
+struct blocked_bench_result_t {
+  int32_t depth_ = 0; // 0 for the lookup table engine
+  blocked_stats_t stats_; // only seconds_ for the lookup table engine
+  uint64_t hash_ = 0;
+};
+
+// steps the same random soup on the torus with the lookup table engine, then
+// with step_blocked at each depth from 1 to max_depth
+std::vector<blocked_bench_result_t> run_blocked_bench(
+  const bench_options_t& options, int32_t max_depth, int32_t threads);
@@ -0,0 +1,218 @@
+#include "bitboard.h"
+
+#include <algorithm>
+#include <bit>
+
+bitboard_t make_bitboard(const int32_t width, const int32_t height) {
+  bitboard_t board;
+  board.width_ = width;
+  board.height_ = height;
+  board.stride_ = (width + 63) / 64;
+  board.words_.resize(size_t(board.stride_) * height);
+  return board;
+}
+
+void clear_bitboard(bitboard_t& board) {
+  std::fill(board.words_.begin(), board.words_.end(), uint64_t(0));
+}
+
+uint64_t bitboard_hash(const bitboard_t& board) {
+  uint64_t hash = 0xcbf29ce484222325;
+  const auto mix = [&hash](const uint64_t value) {
+    hash = (hash ^ value) * 0x9e3779b97f4a7c15;
+    hash ^= hash >> 32;
+  };
+  mix(uint64_t(board.width_));
+  mix(uint64_t(board.height_));
+  for (const uint64_t word : board.words_) {
+    mix(word);
+  }
+  return hash;
+}
+
+int64_t bitboard_population(const bitboard_t& board) {
+  int64_t population = 0;
+  for (const uint64_t word : board.words_) {
+    population += std::popcount(word);
+  }
+  return population;
+}
+
+void blit_bitboard(
+  bitboard_t& board, const bitboard_t& pattern, const int32_t x,
+  const int32_t y) {
+  const uint64_t last_mask = board.width_ % 64 == 0
+                             ? ~uint64_t(0)
+                             : (uint64_t(1) << (board.width_ % 64)) - 1;
+  for (int32_t row = 0; row < pattern.height_; row++) {
+    const int32_t target_y = y + row;
+    if (target_y < 0 || target_y >= board.height_) {
+      continue;
+    }
+    const std::span<const uint64_t> from = bitboard_row(pattern, row);
+    const std::span<uint64_t> to = bitboard_row(board, target_y);
+    for (int32_t word = 0; word < pattern.stride_; word++) {
+      // the word lands across target words index and index + 1 (>> floors)
+      const int32_t target_x = x + word * 64;
+      const int32_t index = target_x >> 6;
+      const int32_t shift = target_x & 63;
+      if (index >= 0 && index < board.stride_) {
+        to[index] |= from[word] << shift;
+      }
+      if (shift != 0 && index + 1 >= 0 && index + 1 < board.stride_) {
+        to[index + 1] |= from[word] >> (64 - shift);
+      }
+    }
+    to.back() &= last_mask;
+  }
+}
+
+namespace {
+
+  // bits [begin, end) of the word starting at cell word * 64
+  uint64_t range_mask(
+    const int32_t word, const int32_t begin, const int32_t end) {
+    const int32_t low = std::clamp(begin - word * 64, 0, 64);
+    const int32_t high = std::clamp(end - word * 64, 0, 64);
+    const uint64_t below_high =
+      high == 64 ? ~uint64_t(0) : (uint64_t(1) << high) - 1;
+    const uint64_t below_low =
+      low == 64 ? ~uint64_t(0) : (uint64_t(1) << low) - 1;
+    return below_high & ~below_low;
+  }
+
+  // swaps ever larger neighboring groups of bits
+  uint64_t reverse_bits(uint64_t word) {
+    constexpr uint64_t masks[] = {
+      0x5555555555555555, 0x3333333333333333, 0x0f0f0f0f0f0f0f0f,
+      0x00ff00ff00ff00ff, 0x0000ffff0000ffff, 0x00000000ffffffff};
+    for (int32_t step = 0; step < 6; step++) {
+      const int32_t width = 1 << step;
+      word = ((word >> width) & masks[step]) | ((word & masks[step]) << width);
+    }
+    return word;
+  }
+
+  // transposes a 64x64 block in place, bit x of row y swaps with bit y of row
+  // x, by swapping ever smaller off diagonal sub-blocks
+  void transpose_block(uint64_t (&rows)[64]) {
+    uint64_t mask = 0x00000000ffffffff;
+    for (int32_t width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+      for (int32_t row = 0; row < 64; row = ((row | width) + 1) & ~width) {
+        const uint64_t swap =
+          ((rows[row] >> width) ^ rows[row | width]) & mask;
+        rows[row] ^= swap << width;
+        rows[row | width] ^= swap;
+      }
+    }
+  }
+
+} // namespace
+
+bitboard_t extract_bitboard(
+  const bitboard_t& board, const int32_t x, const int32_t y,
+  const int32_t width, const int32_t height) {
+  bitboard_t region = make_bitboard(width, height);
+  const uint64_t last_mask =
+    width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1;
+  for (int32_t row = 0; row < height; row++) {
+    const std::span<const uint64_t> from = bitboard_row(board, y + row);
+    const std::span<uint64_t> to = bitboard_row(region, row);
+    for (int32_t word = 0; word < region.stride_; word++) {
+      const int32_t source_x = x + word * 64;
+      const int32_t index = source_x >> 6;
+      const int32_t shift = source_x & 63;
+      uint64_t bits = from[index] >> shift;
+      if (shift != 0 && index + 1 < board.stride_) {
+        bits |= from[index + 1] << (64 - shift);
+      }
+      to[word] = bits;
+    }
+    to.back() &= last_mask;
+  }
+  return region;
+}
+
+void clear_bitboard_region(
+  bitboard_t& board, const int32_t x, const int32_t y, const int32_t width,
+  const int32_t height) {
+  for (int32_t row = y; row < y + height; row++) {
+    const std::span<uint64_t> words = bitboard_row(board, row);
+    for (int32_t word = x >> 6; word <= (x + width - 1) >> 6; word++) {
+      words[word] &= ~range_mask(word, x, x + width);
+    }
+  }
+}
+
+bitboard_t transpose_bitboard(const bitboard_t& board) {
+  bitboard_t result = make_bitboard(board.height_, board.width_);
+  uint64_t block[64];
+  for (int32_t block_y = 0; block_y < result.stride_; block_y++) {
+    for (int32_t block_x = 0; block_x < board.stride_; block_x++) {
+      for (int32_t i = 0; i < 64; i++) {
+        const int32_t y = block_y * 64 + i;
+        block[i] = y < board.height_ ? bitboard_row(board, y)[block_x] : 0;
+      }
+      transpose_block(block);
+      for (int32_t i = 0; i < 64; i++) {
+        const int32_t y = block_x * 64 + i;
+        if (y < result.height_) {
+          bitboard_row(result, y)[block_y] = block[i];
+        }
+      }
+    }
+  }
+  return result;
+}
+
+bitboard_t mirror_bitboard(const bitboard_t& board) {
+  bitboard_t result = make_bitboard(board.width_, board.height_);
+  // reversing the whole row leaves the padding at the start, shift it out
+  const int32_t shift = board.stride_ * 64 - board.width_;
+  for (int32_t y = 0; y < board.height_; y++) {
+    const std::span<const uint64_t> from = bitboard_row(board, y);
+    const std::span<uint64_t> to = bitboard_row(result, y);
+    for (int32_t word = 0; word < board.stride_; word++) {
+      const uint64_t reversed = reverse_bits(from[board.stride_ - 1 - word]);
+      to[word] |= reversed >> shift;
+      if (shift != 0 && word > 0) {
+        to[word - 1] |= reversed << (64 - shift);
+      }
+    }
+  }
+  return result;
+}
+
+bitboard_t flip_bitboard(const bitboard_t& board) {
+  bitboard_t result = make_bitboard(board.width_, board.height_);
+  for (int32_t y = 0; y < board.height_; y++) {
+    const std::span<const uint64_t> from = bitboard_row(board, y);
+    std::copy(
+      from.begin(), from.end(),
+      bitboard_row(result, board.height_ - 1 - y).begin());
+  }
+  return result;
+}
+
+void capture_board(bitboard_t& bitboard, const mc_gol_board_t* board) {
+  for (int32_t y = 0; y < bitboard.height_; y++) {
+    uint64_t* row = bitboard.words_.data() + y * bitboard.stride_;
+    for (int32_t word = 0; word < bitboard.stride_; word++) {
+      uint64_t bits = 0;
+      const int32_t begin = word * 64;
+      const int32_t end = std::min(begin + 64, bitboard.width_);
+      for (int32_t x = begin; x < end; x++) {
+        bits |= uint64_t(mc_gol_board_cell(board, x, y)) << (x - begin);
+      }
+      row[word] = bits;
+    }
+  }
+}
+
+void apply_board(const bitboard_t& bitboard, mc_gol_board_t* board) {
+  for (int32_t y = 0; y < bitboard.height_; y++) {
+    for (int32_t x = 0; x < bitboard.width_; x++) {
+      mc_gol_set_board_cell(board, x, y, bitboard_cell(bitboard, x, y));
+    }
+  }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <minimal-cmake-gol/gol.h>
+
+// packed snapshot of a board, one bit per cell
+// cell (x, y) is bit x % 64 of word x / 64 in row y, bits past the width of
+// the last word in each row are always zero
+struct bitboard_t {
+  int32_t width_ = 0;
+  int32_t height_ = 0;
+  int32_t stride_ = 0; // words per row
+  std::vector<uint64_t> words_;
+};
+
+bitboard_t make_bitboard(int32_t width, int32_t height);
+
+inline bool bitboard_cell(const bitboard_t& board, int32_t x, int32_t y) {
+  return (board.words_[y * board.stride_ + (x >> 6)] >> (x & 63)) & 1;
+}
+
+inline void set_bitboard_cell(
+  bitboard_t& board, int32_t x, int32_t y, bool alive) {
+  uint64_t& word = board.words_[y * board.stride_ + (x >> 6)];
+  const uint64_t bit = uint64_t(1) << (x & 63);
+  word = alive ? word | bit : word & ~bit;
+}
+
+// the stride_ words of row y, so loops can run over the raw bits of a row
+inline std::span<uint64_t> bitboard_row(bitboard_t& board, int32_t y) {
+  return {board.words_.data() + y * board.stride_, size_t(board.stride_)};
+}
+
+inline std::span<const uint64_t> bitboard_row(
+  const bitboard_t& board, int32_t y) {
+  return {board.words_.data() + y * board.stride_, size_t(board.stride_)};
+}
+
+void clear_bitboard(bitboard_t& board);
+uint64_t bitboard_hash(const bitboard_t& board);
+int64_t bitboard_population(const bitboard_t& board);
+
+// ors pattern into board with its top left cell at (x, y), a word at a time,
+// cells falling outside the board are dropped
+void blit_bitboard(
+  bitboard_t& board, const bitboard_t& pattern, int32_t x, int32_t y);
+
+// region operations on packed words, the region must lie on the board
+bitboard_t extract_bitboard(
+  const bitboard_t& board, int32_t x, int32_t y, int32_t width,
+  int32_t height);
+void clear_bitboard_region(
+  bitboard_t& board, int32_t x, int32_t y, int32_t width, int32_t height);
+
+// whole board transforms, transposing runs on 64x64 bit blocks
+bitboard_t transpose_bitboard(const bitboard_t& board);
+bitboard_t mirror_bitboard(const bitboard_t& board); // left to right
+bitboard_t flip_bitboard(const bitboard_t& board); // top to bottom
+
+// copy cells between a mc_gol board and a bitboard of the same size
+void capture_board(bitboard_t& bitboard, const mc_gol_board_t* board);
+void apply_board(const bitboard_t& bitboard, mc_gol_board_t* board);
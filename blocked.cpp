@@ -0,0 +1,204 @@
+#include "blocked.h"
+#include "life_kernel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  // a tile's two buffers are sized to about this together
+  constexpr int64_t g_tile_bytes = 512 * 1024;
+
+  // per thread rows of a tile, padded as halo_board_t rows, stepped from one
+  // buffer into the other
+  struct tile_t {
+    std::vector<uint64_t> rows_[2];
+    std::vector<uint64_t> cells_; // a mirrored board row before it's padded
+  };
+
+  int32_t floor_div(const int32_t value, const int32_t divisor) {
+    return value / divisor - (value % divisor < 0 ? 1 : 0);
+  }
+
+  // pads row y (wrapped onto the board for the joined topologies, those past
+  // the top or bottom mirrored for the Klein bottle and cross-surface) into
+  // padded, with side ghosts as fill_halo makes them
+  void load_row(
+    const bitboard_t& board, const topology_e topology, const int32_t y,
+    uint64_t* padded, std::vector<uint64_t>& cells) {
+    const int32_t width = board.width_;
+    const int32_t height = board.height_;
+    const int32_t wraps = floor_div(y, height);
+    const int32_t source = y - wraps * height;
+    const bool mirrored = topology != topology_e::torus && (wraps & 1) != 0;
+    const std::span<const uint64_t> row = bitboard_row(board, source);
+    const uint64_t* words = row.data();
+    if (mirrored) {
+      cells.assign(row.size(), uint64_t(0));
+      for (int32_t x = 0; x < width; x++) {
+        const int32_t from = width - 1 - x;
+        cells[x >> 6] |= ((row[from >> 6] >> (from & 63)) & 1) << (x & 63);
+      }
+      words = cells.data();
+    }
+    uint64_t carry = 0;
+    for (int32_t word = 0; word < board.stride_; word++) {
+      padded[word] = (words[word] << 1) | carry;
+      carry = words[word] >> 63;
+    }
+    padded[board.stride_] = carry;
+    if (topology == topology_e::plane) {
+      return;
+    }
+    // the cross-surface's sides join the mirrored row (only read by the
+    // first generation of a pass)
+    uint64_t side_cells[2] = {
+      (words[(width - 1) >> 6] >> ((width - 1) & 63)) & 1, words[0] & 1};
+    if (topology == topology_e::cross_surface) {
+      const int32_t side = height - 1 - source;
+      const bool left = bitboard_cell(board, width - 1, side);
+      const bool right = bitboard_cell(board, 0, side);
+      side_cells[0] = mirrored ? right : left;
+      side_cells[1] = mirrored ? left : right;
+    }
+    padded[0] |= side_cells[0];
+    padded[(width + 1) >> 6] |= side_cells[1] << ((width + 1) & 63);
+  }
+
+  // board rows [top, bottom) of the generation depth after board's into next
+  void step_tile(
+    const bitboard_t& board, bitboard_t& next, const topology_e topology,
+    const int32_t top, const int32_t bottom, const int32_t depth,
+    tile_t& tile, blocked_stats_t& stats) {
+    const int32_t width = board.width_;
+    const int32_t stride = board.stride_ + 1;
+    const bool plane = topology == topology_e::plane;
+    // rows past the edges of the plane stay dead, so the tile stops there
+    // and doesn't shrink from that side
+    const int32_t low = plane ? std::max(top - depth, 0) : top - depth;
+    const int32_t high =
+      plane ? std::min(bottom + depth, board.height_) : bottom + depth;
+    const bool fixed_low = plane && low == 0;
+    const bool fixed_high = plane && high == board.height_;
+    // buffer row y - low + 1 holds row y, with a zero row either end (only
+    // read past the edges of the plane), rows are only read once written
+    const int32_t buffer_rows = high - low + 2;
+    for (std::vector<uint64_t>& rows : tile.rows_) {
+      rows.resize(size_t(buffer_rows) * stride);
+      std::fill_n(rows.begin(), stride, uint64_t(0));
+      std::fill_n(
+        rows.begin() + int64_t(buffer_rows - 1) * stride, stride, uint64_t(0));
+    }
+    for (int32_t y = low; y < high; y++) {
+      load_row(
+        board, topology, y, tile.rows_[0].data() + (y - low + 1) * stride,
+        tile.cells_);
+    }
+    stats.bytes_read_ += int64_t(high - low) * board.stride_ * 8;
+
+    const uint64_t last_mask =
+      width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1;
+    for (int32_t generation = 1; generation <= depth; generation++) {
+      const uint64_t* from = tile.rows_[(generation - 1) % 2].data();
+      uint64_t* to = tile.rows_[generation % 2].data();
+      const int32_t first = fixed_low ? low : low + generation;
+      const int32_t last = fixed_high ? high : high - generation;
+      for (int32_t y = first; y < last; y++) {
+        const uint64_t* above = from + (y - low) * stride;
+        const uint64_t* row = above + stride;
+        const uint64_t* below = row + stride;
+        uint64_t* out = to + (y - low + 1) * stride;
+        uint64_t carry = 0;
+        for (int32_t word = 0; word < board.stride_; word++) {
+          const uint64_t cells =
+            life_word(
+              above[word], above[word + 1], row[word], row[word + 1],
+              below[word], below[word + 1])
+            & (word == board.stride_ - 1 ? last_mask : ~uint64_t(0));
+          out[word] = (cells << 1) | carry;
+          carry = cells >> 63;
+        }
+        out[board.stride_] = carry;
+        if (!plane) {
+          out[0] |= (out[width >> 6] >> (width & 63)) & 1;
+          out[(width + 1) >> 6] |= ((out[0] >> 1) & 1) << ((width + 1) & 63);
+        }
+      }
+      stats.rows_stepped_ += last - first;
+    }
+
+    const uint64_t* result = tile.rows_[depth % 2].data();
+    for (int32_t y = top; y < bottom; y++) {
+      const uint64_t* padded = result + (y - low + 1) * stride;
+      uint64_t* out = next.words_.data() + int64_t(y) * board.stride_;
+      for (int32_t word = 0; word < board.stride_; word++) {
+        out[word] = (padded[word] >> 1) | (padded[word + 1] << 63);
+      }
+      out[board.stride_ - 1] &= last_mask;
+    }
+    stats.bytes_written_ += int64_t(bottom - top) * board.stride_ * 8;
+  }
+
+} // namespace
+
+blocked_stats_t step_blocked(
+  bitboard_t& board, const topology_e topology, const int32_t generations,
+  const blocked_options_t& options) {
+  blocked_stats_t stats;
+  const auto begin = std::chrono::steady_clock::now();
+  const int32_t depth = topology == topology_e::cross_surface
+                        ? 1
+                        : std::max(options.depth_, 1);
+  const int64_t row_bytes = int64_t(board.stride_ + 1) * 8;
+  const int32_t tile_rows = std::clamp(
+    options.tile_rows_ > 0
+      ? options.tile_rows_
+      : int32_t(std::max<int64_t>(
+        g_tile_bytes / (2 * row_bytes) - 2 * depth, depth * 4)),
+    1, std::max(board.height_, 1));
+  const int32_t tiles = (board.height_ + tile_rows - 1) / tile_rows;
+  const int32_t thread_count = std::clamp(
+    options.threads_ > 0
+      ? options.threads_
+      : int32_t(std::thread::hardware_concurrency()),
+    1, std::max(tiles, 1));
+  bitboard_t next = make_bitboard(board.width_, board.height_);
+
+  for (int32_t done = 0; done < generations; done += depth) {
+    const int32_t pass_depth = std::min(depth, generations - done);
+    std::atomic<int32_t> next_tile = 0;
+    std::vector<blocked_stats_t> thread_stats(thread_count);
+    const auto worker = [&](const int32_t thread) {
+      tile_t tile;
+      for (int32_t index = next_tile++; index < tiles; index = next_tile++) {
+        step_tile(
+          board, next, topology, index * tile_rows,
+          std::min((index + 1) * tile_rows, board.height_), pass_depth, tile,
+          thread_stats[thread]);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int32_t thread = 1; thread < thread_count; thread++) {
+      threads.emplace_back(worker, thread);
+    }
+    worker(0);
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    for (const blocked_stats_t& counted : thread_stats) {
+      stats.bytes_read_ += counted.bytes_read_;
+      stats.bytes_written_ += counted.bytes_written_;
+      stats.rows_stepped_ += counted.rows_stepped_;
+    }
+    std::swap(board.words_, next.words_);
+  }
+
+  stats.seconds_ = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - begin)
+                     .count();
+  return stats;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "bitboard.h"
+#include "topology.h"
+
+#include <cstdint>
+
+struct blocked_options_t {
+  int32_t depth_ = 4; // generations each tile is advanced per pass (k)
+  int32_t tile_rows_ = 0; // board rows a tile writes, 0 to fit it in ~512KB
+  int32_t threads_ = 0; // 0 to use every core
+};
+
+// traffic between the tiles and the board, which is all that has to come
+// from memory once a board is bigger than the caches
+struct blocked_stats_t {
+  int64_t bytes_read_ = 0;
+  int64_t bytes_written_ = 0;
+  int64_t rows_stepped_ = 0; // including the halo rows stepped by two tiles
+  double seconds_ = 0.0;
+};
+
+// advances board generations, depth_ at a time: each tile of full width rows
+// is copied with depth_ rows either side and stepped depth_ generations in
+// cache (its halo shrinking a row a generation) before its own rows are
+// written back, tiles overlap so threads step them independently. the
+// cross-surface joins its sides to rows at the far end of the board, so it's
+// only stepped a generation per pass
+blocked_stats_t step_blocked(
+  bitboard_t& board, topology_e topology, int32_t generations,
+  const blocked_options_t& options);
@@ -0,0 +1,374 @@
+#include "census.h"
+#include "engine.h"
+#include "random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+  // longest oscillator/spaceship period recognised
+  constexpr int32_t g_max_period = 30;
+  // space around an isolated object, enough for a c/2 ship to move a period
+  constexpr int32_t g_margin = g_max_period / 2 + 4;
+
+  struct bounds_t {
+    int32_t min_x = INT32_MAX;
+    int32_t min_y = INT32_MAX;
+    int32_t max_x = INT32_MIN;
+    int32_t max_y = INT32_MIN;
+  };
+
+  bounds_t cell_bounds(const std::vector<cell_t>& cells) {
+    bounds_t bounds;
+    for (const cell_t& cell : cells) {
+      bounds.min_x = std::min(bounds.min_x, cell.x);
+      bounds.min_y = std::min(bounds.min_y, cell.y);
+      bounds.max_x = std::max(bounds.max_x, cell.x);
+      bounds.max_y = std::max(bounds.max_y, cell.y);
+    }
+    return bounds;
+  }
+
+  std::vector<cell_t> board_cells(const bitboard_t& board) {
+    std::vector<cell_t> cells;
+    for (int32_t y = 0; y < board.height_; y++) {
+      for (int32_t word = 0; word < board.stride_; word++) {
+        for (uint64_t bits = board.words_[y * board.stride_ + word]; bits != 0;
+             bits &= bits - 1) {
+          cells.push_back({word * 64 + std::countr_zero(bits), y});
+        }
+      }
+    }
+    return cells;
+  }
+
+  // steps the object on an empty board with the lookup table engine until it
+  // returns to its first shape
+  census_object_t evolve_object(const std::vector<cell_t>& cells) {
+    census_object_t object;
+    if (cells.empty()) {
+      return object;
+    }
+    const bounds_t bounds = cell_bounds(cells);
+    const int32_t width = bounds.max_x - bounds.min_x + 1 + g_margin * 2;
+    const int32_t height = bounds.max_y - bounds.min_y + 1 + g_margin * 2;
+    bitboard_t board = make_bitboard(width, height);
+    for (const cell_t& cell : cells) {
+      set_bitboard_cell(
+        board, cell.x - bounds.min_x + g_margin,
+        cell.y - bounds.min_y + g_margin, true);
+    }
+    // nothing reaches the edges before it's given up on
+    engine_t engine;
+    engine.topology_ = topology_e::plane;
+
+    const std::string first = normalized_code(cells);
+    std::string canonical = canonical_code(cells);
+    auto population = static_cast<int32_t>(cells.size());
+    for (int32_t period = 1; period <= g_max_period; period++) {
+      step_engine(engine, board);
+      const std::vector<cell_t> phase = board_cells(board);
+      if (phase.empty()) {
+        break;
+      }
+      const bounds_t phase_bounds = cell_bounds(phase);
+      if (
+        phase_bounds.min_x == 0 || phase_bounds.min_y == 0
+        || phase_bounds.max_x == width - 1
+        || phase_bounds.max_y == height - 1) {
+        break; // grew out of its margin
+      }
+      if (normalized_code(phase) == first) {
+        const bool moved =
+          phase_bounds.min_x != g_margin || phase_bounds.min_y != g_margin;
+        object.kind_ = period == 1 ? object_kind_e::still_life
+                     : moved       ? object_kind_e::spaceship
+                                   : object_kind_e::oscillator;
+        object.period_ = period;
+        object.population_ = population;
+        object.code_ = canonical;
+        break;
+      }
+      std::string code = canonical_code(phase);
+      if (code < canonical) {
+        canonical = std::move(code);
+        population = static_cast<int32_t>(phase.size());
+      }
+    }
+    return object;
+  }
+
+  struct known_object_t {
+    const char* name;
+    std::vector<const char*> rows; // 'o' for alive cells
+  };
+
+  const std::map<std::string, std::string>& known_names() {
+    static const std::map<std::string, std::string> names = [] {
+      const known_object_t known[] = {
+        {"block", {"oo", "oo"}},
+        {"beehive", {".oo.", "o..o", ".oo."}},
+        {"loaf", {".oo.", "o..o", ".o.o", "..o."}},
+        {"boat", {"oo.", "o.o", ".o."}},
+        {"ship", {"oo.", "o.o", ".oo"}},
+        {"tub", {".o.", "o.o", ".o."}},
+        {"pond", {".oo.", "o..o", "o..o", ".oo."}},
+        {"barge", {".o..", "o.o.", ".o.o", "..o."}},
+        {"long boat", {".o..", "o.o.", ".o.o", "..oo"}},
+        {"snake", {"oo.o", "o.oo"}},
+        {"mango", {".oo..", "o..o.", ".o..o", "..oo."}},
+        {"eater 1", {"oo..", "o.o.", "..o.", "..oo"}},
+        {"aircraft carrier", {"oo..", "o..o", "..oo"}},
+        {"blinker", {"ooo"}},
+        {"toad", {".ooo", "ooo."}},
+        {"beacon", {"oo..", "o...", "...o", "..oo"}},
+        {"clock", {"..o.", "o.o.", ".o.o", ".o.."}},
+        {"pulsar",
+         {"..ooo...ooo..", ".............", "o....o.o....o",
+          "o....o.o....o", "o....o.o....o", "..ooo...ooo..",
+          ".............", "..ooo...ooo..", "o....o.o....o",
+          "o....o.o....o", "o....o.o....o", ".............",
+          "..ooo...ooo.."}},
+        {"pentadecathlon", {"..o....o..", "oo.oooo.oo", "..o....o.."}},
+        {"glider", {".o.", "..o", "ooo"}},
+        {"lightweight spaceship", {".o..o", "o....", "o...o", "oooo."}},
+        {"middleweight spaceship",
+         {"...o..", ".o...o", "o.....", "o....o", "ooooo."}},
+        {"heavyweight spaceship",
+         {"...oo..", ".o....o", "o......", "o.....o", "oooooo."}},
+      };
+      std::map<std::string, std::string> names;
+      for (const known_object_t& object : known) {
+        std::vector<cell_t> cells;
+        for (int32_t y = 0; y < int32_t(object.rows.size()); y++) {
+          for (int32_t x = 0; object.rows[y][x] != '\0'; x++) {
+            if (object.rows[y][x] == 'o') {
+              cells.push_back({x, y});
+            }
+          }
+        }
+        names[evolve_object(cells).code_] = object.name;
+      }
+      return names;
+    }();
+    return names;
+  }
+
+  std::string object_label(const census_object_t& object) {
+    const auto name = known_names().find(object.code_);
+    if (name != known_names().end()) {
+      return name->second;
+    }
+    switch (object.kind_) {
+      case object_kind_e::still_life:
+        return "xs" + std::to_string(object.population_) + " " + object.code_;
+      case object_kind_e::oscillator:
+        return "xp" + std::to_string(object.period_) + " " + object.code_;
+      case object_kind_e::spaceship:
+        return "xq" + std::to_string(object.period_) + " " + object.code_;
+      default:
+        return "unstable";
+    }
+  }
+
+  // population has repeated with a period up to g_max_period for long enough
+  bool population_settled(const std::vector<int64_t>& populations) {
+    const auto count = static_cast<int32_t>(populations.size());
+    const int64_t* const last = populations.data() + count - 1;
+    for (int32_t period = 1; period <= g_max_period; period++) {
+      const int32_t window = period * 2 + 16;
+      if (count < window + period) {
+        return false;
+      }
+      bool repeating = true;
+      for (int32_t i = 0; i < window && repeating; i++) {
+        repeating = last[-i] == last[-i - period];
+      }
+      if (repeating) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+} // namespace
+
+std::string normalized_code(const std::vector<cell_t>& cells) {
+  const bounds_t bounds = cell_bounds(cells);
+  const int32_t width = bounds.max_x - bounds.min_x + 1;
+  const int32_t height = bounds.max_y - bounds.min_y + 1;
+  const int32_t digits = (width + 3) / 4;
+  std::vector<uint8_t> nibbles(size_t(digits) * height);
+  for (const cell_t& cell : cells) {
+    const int32_t x = cell.x - bounds.min_x;
+    const int32_t y = cell.y - bounds.min_y;
+    nibbles[y * digits + x / 4] |= uint8_t(1 << (x % 4));
+  }
+  std::string code = std::to_string(width) + "x" + std::to_string(height) + ":";
+  for (int32_t y = 0; y < height; y++) {
+    if (y != 0) {
+      code += '.';
+    }
+    for (int32_t digit = 0; digit < digits; digit++) {
+      code += "0123456789abcdef"[nibbles[y * digits + digit]];
+    }
+  }
+  return code;
+}
+
+std::string canonical_code(const std::vector<cell_t>& cells) {
+  std::string canonical;
+  std::vector<cell_t> oriented(cells.size());
+  for (int32_t orientation = 0; orientation < 8; orientation++) {
+    std::transform(
+      cells.begin(), cells.end(), oriented.begin(),
+      [orientation](cell_t cell) {
+        if (orientation & 1) {
+          cell.x = -cell.x;
+        }
+        if (orientation & 2) {
+          cell.y = -cell.y;
+        }
+        if (orientation & 4) {
+          std::swap(cell.x, cell.y);
+        }
+        return cell;
+      });
+    std::string code = normalized_code(oriented);
+    if (canonical.empty() || code < canonical) {
+      canonical = std::move(code);
+    }
+  }
+  return canonical;
+}
+
+census_object_t classify_object(const std::vector<cell_t>& cells) {
+  census_object_t object = evolve_object(cells);
+  object.name_ = object_label(object);
+  return object;
+}
+
+std::vector<std::vector<cell_t>> find_objects(const bitboard_t& board) {
+  std::vector<std::vector<cell_t>> objects;
+  std::vector<uint8_t> visited(size_t(board.width_) * board.height_);
+  std::vector<cell_t> stack;
+  for (const cell_t seed : board_cells(board)) {
+    if (visited[seed.y * board.width_ + seed.x]) {
+      continue;
+    }
+    visited[seed.y * board.width_ + seed.x] = 1;
+    std::vector<cell_t>& object = objects.emplace_back();
+    // coordinates are kept unwrapped so objects crossing an edge stay whole
+    stack.push_back(seed);
+    while (!stack.empty()) {
+      const cell_t cell = stack.back();
+      stack.pop_back();
+      object.push_back(cell);
+      for (int32_t dy = -1; dy <= 1; dy++) {
+        for (int32_t dx = -1; dx <= 1; dx++) {
+          const int32_t x = (cell.x + dx + board.width_) % board.width_;
+          const int32_t y = (cell.y + dy + board.height_) % board.height_;
+          if (bitboard_cell(board, x, y) && !visited[y * board.width_ + x]) {
+            visited[y * board.width_ + x] = 1;
+            stack.push_back({cell.x + dx, cell.y + dy});
+          }
+        }
+      }
+    }
+  }
+  return objects;
+}
+
+census_result_t run_census(const census_options_t& options) {
+  known_names(); // build once up front rather than racing inside the workers
+
+  census_result_t result;
+  std::mutex result_mutex;
+  std::atomic<int64_t> next_soup = 0;
+  const auto begin = std::chrono::steady_clock::now();
+
+  const auto worker = [&] {
+    const int32_t size = options.board_size_;
+    const int32_t offset = (size - options.soup_size_) / 2;
+    mc_gol_board_t* board = mc_gol_create_board(size, size);
+    bitboard_t snapshot = make_bitboard(size, size);
+    std::vector<int64_t> populations;
+    // objects seen by this worker by their shape (not canonical) code
+    std::unordered_map<std::string, census_object_t> classified;
+    std::map<std::string, int64_t> counts;
+    int64_t soups = 0;
+    int64_t unstabilised = 0;
+
+    for (int64_t soup = next_soup++; soup < options.soups_;
+         soup = next_soup++) {
+      // seeded per soup so results don't depend on the thread count
+      xoshiro256_t rng =
+        make_xoshiro256(options.seed_ ^ (uint64_t(soup) * 0x9e3779b97f4a7c15));
+      clear_bitboard(snapshot);
+      for (int32_t y = 0; y < options.soup_size_; y++) {
+        for (int32_t x = 0; x < options.soup_size_; x++) {
+          if (xoshiro256_unit(rng) < options.density_) {
+            set_bitboard_cell(snapshot, offset + x, offset + y, true);
+          }
+        }
+      }
+      apply_board(snapshot, board);
+
+      populations.clear();
+      bool settled = false;
+      for (int32_t generation = 0;
+           generation < options.max_generations_ && !settled; generation++) {
+        mc_gol_update_board(board);
+        capture_board(snapshot, board);
+        populations.push_back(bitboard_population(snapshot));
+        settled = population_settled(populations);
+      }
+      soups++;
+      if (!settled) {
+        unstabilised++;
+        continue;
+      }
+
+      for (const std::vector<cell_t>& cells : find_objects(snapshot)) {
+        const std::string shape = normalized_code(cells);
+        auto object = classified.find(shape);
+        if (object == classified.end()) {
+          object = classified.emplace(shape, classify_object(cells)).first;
+        }
+        counts[object->second.name_]++;
+      }
+    }
+    mc_gol_destroy_board(board);
+
+    std::lock_guard lock(result_mutex);
+    for (const auto& [name, count] : counts) {
+      result.counts_[name] += count;
+    }
+    result.soups_ += soups;
+    result.unstabilised_ += unstabilised;
+  };
+
+  const int32_t thread_count =
+    options.threads_ > 0
+      ? options.threads_
+      : std::max(int32_t(std::thread::hardware_concurrency()), 1);
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < thread_count; i++) {
+    threads.emplace_back(worker);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  result.seconds_ = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+  return result;
+}
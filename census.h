@@ -0,0 +1,58 @@
+#pragma once
+
+#include "bitboard.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct cell_t {
+  int32_t x;
+  int32_t y;
+};
+
+enum class object_kind_e { still_life, oscillator, spaceship, unstable };
+
+// an isolated object identified by evolving it on its own until it repeats,
+// code_ is the same for every phase and all 8 orientations of the object
+struct census_object_t {
+  object_kind_e kind_ = object_kind_e::unstable;
+  int32_t period_ = 0;
+  int32_t population_ = 0; // of the canonical phase
+  std::string code_;
+  std::string name_; // common name or a label built from kind, period and code
+};
+
+census_object_t classify_object(const std::vector<cell_t>& cells);
+
+// bounding box size and one hex row per line, e.g. "2x2:3.3" for a block, the
+// same for the same shape wherever it is (but not rotated or reflected)
+std::string normalized_code(const std::vector<cell_t>& cells);
+
+// the smallest normalized_code of the shape's 8 rotations and reflections
+std::string canonical_code(const std::vector<cell_t>& cells);
+
+// splits a board into 8-connected objects (wrapping at the edges)
+std::vector<std::vector<cell_t>> find_objects(const bitboard_t& board);
+
+struct census_options_t {
+  int64_t soups_ = 1000;
+  int32_t soup_size_ = 16; // soups are soup_size_ squared in the board center
+  int32_t board_size_ = 96;
+  int32_t max_generations_ = 8000; // soups still active after are skipped
+  int32_t threads_ = 0; // 0 to use every core
+  double density_ = 0.5;
+  uint64_t seed_ = 1;
+};
+
+struct census_result_t {
+  std::map<std::string, int64_t> counts_; // by census_object_t::name_
+  int64_t soups_ = 0;
+  int64_t unstabilised_ = 0;
+  double seconds_ = 0.0;
+};
+
+// apgsearch style census, steps random soups until their population settles
+// into a short cycle then classifies the ash, one soup per task on all cores
+census_result_t run_census(const census_options_t& options);
@@ -0,0 +1,305 @@
+#include "control.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+  // longest line accepted before the client is dropped
+  constexpr size_t g_max_line = 1 << 20;
+
+  struct client_t {
+    uint64_t id_ = 0;
+    int fd_ = -1;
+    std::string input_; // bytes after the last complete line
+    std::string output_; // replies not yet written
+    control_batch_t batch_; // commands of the batch being read
+    int32_t outstanding_ = 0; // batches handed over but not answered
+    bool finished_ = false; // sent everything it's going to (or hung up)
+    bool failed_ = false;
+  };
+
+  // a client that has stopped sending stays connected until it has every
+  // reply, so "printf 'step 10\npopulation\n' | nc -U <path>" works
+  bool done(const client_t& client) {
+    return client.failed_
+        || (client.finished_ && client.outstanding_ == 0
+            && client.output_.empty());
+  }
+
+  void hand_over(control_server_t& server, client_t& client) {
+    client.batch_.client_ = client.id_;
+    client.outstanding_++;
+    std::lock_guard lock(server.mutex_);
+    server.received_.push_back(std::move(client.batch_));
+    client.batch_ = control_batch_t{};
+  }
+
+  // a socket nothing is listening on, left behind by a run that crashed, is
+  // the only thing at path that's safe to replace
+  bool stale_socket(const sockaddr_un& address) {
+    struct stat status = {};
+    if (lstat(address.sun_path, &status) != 0 || !S_ISSOCK(status.st_mode)) {
+      return false;
+    }
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return false;
+    }
+    const bool refused =
+      connect(
+        fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address))
+        != 0
+      && errno == ECONNREFUSED;
+    close(fd);
+    return refused;
+  }
+
+  void set_non_blocking(const int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+
+  // splits complete lines off the input, an empty line ends a batch
+  void read_lines(control_server_t& server, client_t& client) {
+    size_t start = 0;
+    for (size_t end; (end = client.input_.find('\n', start))
+                     != std::string::npos;
+         start = end + 1) {
+      std::string line = client.input_.substr(start, end - start);
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      if (!line.empty()) {
+        client.batch_.commands_.push_back(std::move(line));
+      } else if (!client.batch_.commands_.empty()) {
+        hand_over(server, client);
+      }
+    }
+    client.input_.erase(0, start);
+    client.failed_ = client.failed_ || client.input_.size() > g_max_line;
+  }
+
+  void receive(control_server_t& server, client_t& client) {
+    char buffer[4096];
+    for (;;) {
+      const ssize_t size = read(client.fd_, buffer, sizeof(buffer));
+      if (size > 0) {
+        client.input_.append(buffer, size_t(size));
+        continue;
+      }
+      if (size == 0) {
+        client.finished_ = true;
+      } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        client.failed_ = true;
+      }
+      break;
+    }
+    // the last line doesn't need its newline or the last batch its empty line
+    if (client.finished_ && !client.input_.empty()) {
+      client.input_ += '\n';
+    }
+    read_lines(server, client);
+    if (client.finished_ && !client.batch_.commands_.empty()) {
+      hand_over(server, client);
+    }
+  }
+
+  void send(client_t& client) {
+    while (!client.output_.empty()) {
+      const ssize_t size = ::send(
+        client.fd_, client.output_.data(), client.output_.size(),
+        MSG_NOSIGNAL);
+      if (size < 0) {
+        client.failed_ = errno != EAGAIN && errno != EWOULDBLOCK;
+        return;
+      }
+      client.output_.erase(0, size_t(size));
+    }
+  }
+
+  void serve(control_server_t& server) {
+    std::vector<client_t> clients;
+    uint64_t next_id = 1;
+    std::vector<pollfd> fds;
+    while (!server.stopping_) {
+      fds.clear();
+      fds.push_back({server.listen_fd_, POLLIN, 0});
+      fds.push_back({server.wake_fds_[0], POLLIN, 0});
+      for (const client_t& client : clients) {
+        // a finished client waiting on the main thread is left out, as it
+        // would report a hang up every poll
+        const bool idle = client.finished_ && client.output_.empty();
+        fds.push_back(
+          {idle ? -1 : client.fd_,
+           short(
+             (client.finished_ ? 0 : POLLIN)
+             | (client.output_.empty() ? 0 : POLLOUT)),
+           0});
+      }
+      if (poll(fds.data(), nfds_t(fds.size()), -1) < 0 && errno != EINTR) {
+        break;
+      }
+
+      if (fds[1].revents & POLLIN) {
+        char drain[64];
+        while (read(server.wake_fds_[0], drain, sizeof(drain)) > 0) {
+        }
+        std::vector<control_batch_t> answered;
+        {
+          std::lock_guard lock(server.mutex_);
+          std::swap(answered, server.answered_);
+        }
+        for (const control_batch_t& batch : answered) {
+          const auto client = std::find_if(
+            clients.begin(), clients.end(),
+            [&batch](const client_t& c) { return c.id_ == batch.client_; });
+          if (client == clients.end()) {
+            continue; // hung up before the batch was run
+          }
+          client->outstanding_--;
+          for (const std::string& reply : batch.replies_) {
+            client->output_ += reply;
+            client->output_ += '\n';
+          }
+          client->output_ += '\n';
+        }
+      }
+
+      for (size_t i = 0; i < clients.size(); i++) {
+        const short events = fds[i + 2].revents;
+        if (!clients[i].finished_ && (events & (POLLIN | POLLHUP | POLLERR))) {
+          receive(server, clients[i]);
+        }
+      }
+      for (client_t& client : clients) {
+        send(client);
+      }
+      clients.erase(
+        std::remove_if(
+          clients.begin(), clients.end(),
+          [](const client_t& client) {
+            if (done(client)) {
+              close(client.fd_);
+            }
+            return done(client);
+          }),
+        clients.end());
+
+      if (fds[0].revents & POLLIN) {
+        for (int fd; (fd = accept(server.listen_fd_, nullptr, nullptr)) >= 0;) {
+          set_non_blocking(fd);
+          client_t& client = clients.emplace_back();
+          client.id_ = next_id++;
+          client.fd_ = fd;
+        }
+      }
+    }
+    for (const client_t& client : clients) {
+      close(client.fd_);
+    }
+  }
+
+} // namespace
+
+bool open_control(control_server_t& server, const char* path) {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (std::strlen(path) >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::strcpy(address.sun_path, path);
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+  if (stale_socket(address)) {
+    unlink(path);
+  }
+  // anything else at path (another instance's socket or a file) fails the
+  // bind with EADDRINUSE
+  if (
+    bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address))
+    != 0) {
+    const int error = errno;
+    close(fd);
+    errno = error;
+    return false;
+  }
+  if (listen(fd, 8) != 0 || pipe(server.wake_fds_) != 0) {
+    const int error = errno;
+    close(fd);
+    unlink(path); // bound by this process, so it's ours to remove
+    errno = error;
+    return false;
+  }
+  set_non_blocking(fd);
+  set_non_blocking(server.wake_fds_[0]);
+  set_non_blocking(server.wake_fds_[1]);
+  server.path_ = path;
+  server.listen_fd_ = fd;
+  server.stopping_ = false;
+  server.thread_ = std::thread(serve, std::ref(server));
+  return true;
+}
+
+std::vector<control_batch_t> take_control_batches(control_server_t& server) {
+  std::vector<control_batch_t> batches;
+  std::lock_guard lock(server.mutex_);
+  std::swap(batches, server.received_);
+  return batches;
+}
+
+void answer_control_batch(control_server_t& server, control_batch_t batch) {
+  {
+    std::lock_guard lock(server.mutex_);
+    server.answered_.push_back(std::move(batch));
+  }
+  const char wake = 1;
+  [[maybe_unused]] const ssize_t written =
+    write(server.wake_fds_[1], &wake, 1);
+}
+
+void close_control(control_server_t& server) {
+  if (server.listen_fd_ < 0) {
+    return;
+  }
+  server.stopping_ = true;
+  const char wake = 1;
+  [[maybe_unused]] const ssize_t written =
+    write(server.wake_fds_[1], &wake, 1);
+  server.thread_.join();
+  close(server.listen_fd_);
+  close(server.wake_fds_[0]);
+  close(server.wake_fds_[1]);
+  unlink(server.path_.c_str());
+  server.listen_fd_ = -1;
+}
+
+#else
+
+bool open_control(control_server_t&, const char*) {
+  return false; // no unix domain sockets
+}
+
+std::vector<control_batch_t> take_control_batches(control_server_t&) {
+  return {};
+}
+
+void answer_control_batch(control_server_t&, control_batch_t) {
+}
+
+void close_control(control_server_t&) {
+}
+
+#endif
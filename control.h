@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// commands from one client sent in one go, a command a line and an empty line
+// to end the batch, answered with a reply line per command and an empty line
+struct control_batch_t {
+  uint64_t client_ = 0;
+  std::vector<std::string> commands_;
+  std::vector<std::string> replies_;
+};
+
+// a unix domain socket (not available on Windows) served by its own thread
+// with non-blocking sockets, batches are run by the main thread between
+// frames so a slow client never holds up the simulation
+struct control_server_t {
+  std::string path_;
+  int listen_fd_ = -1;
+  int wake_fds_[2] = {-1, -1}; // written to when there are replies to send
+  std::thread thread_;
+  std::atomic<bool> stopping_ = false;
+  std::mutex mutex_;
+  std::vector<control_batch_t> received_; // guarded by mutex_
+  std::vector<control_batch_t> answered_; // guarded by mutex_
+};
+
+// listens at path, replacing a socket left there by a run that crashed, false
+// (with errno set, EADDRINUSE if path is taken) if it can't
+bool open_control(control_server_t& server, const char* path);
+// batches received since the last call, oldest first
+std::vector<control_batch_t> take_control_batches(control_server_t& server);
+// hands the batch (with its replies_ filled in) back to be written out
+void answer_control_batch(control_server_t& server, control_batch_t batch);
+void close_control(control_server_t& server);
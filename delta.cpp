@@ -0,0 +1,104 @@
+#include "delta.h"
+
+namespace {
+
+  void write_varint(std::vector<uint8_t>& bytes, uint64_t value) {
+    do {
+      bytes.push_back(uint8_t((value & 0x7f) | (value >= 0x80 ? 0x80 : 0)));
+      value >>= 7;
+    } while (value != 0);
+  }
+
+  uint64_t read_varint(const uint8_t*& data) {
+    uint64_t value = 0;
+    for (int32_t shift = 0;; shift += 7) {
+      const uint8_t byte = *data++;
+      value |= uint64_t(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+  }
+
+  // as read_varint, false if it runs past end or 64 bits
+  bool read_varint(
+    const uint8_t*& data, const uint8_t* const end, uint64_t& value) {
+    value = 0;
+    for (int32_t shift = 0; shift < 64; shift += 7) {
+      if (data == end) {
+        return false;
+      }
+      const uint8_t byte = *data++;
+      value |= uint64_t(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+} // namespace
+
+std::vector<uint8_t> encode_delta(
+  const std::vector<uint64_t>& from, const std::vector<uint64_t>& to) {
+  std::vector<uint8_t> delta;
+  const size_t count = from.size();
+  size_t word = 0;
+  while (word < count) {
+    const size_t zeros_begin = word;
+    while (word < count && from[word] == to[word]) {
+      word++;
+    }
+    const size_t literals_begin = word;
+    while (word < count && from[word] != to[word]) {
+      word++;
+    }
+    write_varint(delta, literals_begin - zeros_begin);
+    write_varint(delta, word - literals_begin);
+    for (size_t i = literals_begin; i < word; i++) {
+      const uint64_t bits = from[i] ^ to[i];
+      for (int32_t byte = 0; byte < 8; byte++) {
+        delta.push_back(uint8_t(bits >> (byte * 8)));
+      }
+    }
+  }
+  return delta;
+}
+
+bool check_delta(
+  const uint8_t* const delta, const size_t size, const size_t words) {
+  const uint8_t* data = delta;
+  const uint8_t* const end = data + size;
+  uint64_t word = 0;
+  while (data != end) {
+    uint64_t zeros = 0;
+    uint64_t literals = 0;
+    if (
+      !read_varint(data, end, zeros) || !read_varint(data, end, literals)
+      || zeros > words - word || literals > words - word - zeros
+      || literals > uint64_t(end - data) / 8) {
+      return false;
+    }
+    word += zeros + literals;
+    data += literals * 8;
+  }
+  return true;
+}
+
+void apply_delta(
+  std::vector<uint64_t>& words, const uint8_t* delta, const size_t size) {
+  const uint8_t* data = delta;
+  const uint8_t* const end = data + size;
+  size_t word = 0;
+  while (data != end) {
+    word += read_varint(data);
+    const uint64_t literals = read_varint(data);
+    for (uint64_t i = 0; i < literals; i++, word++) {
+      uint64_t bits = 0;
+      for (int32_t byte = 0; byte < 8; byte++) {
+        bits |= uint64_t(*data++) << (byte * 8);
+      }
+      words[word] ^= bits;
+    }
+  }
+}
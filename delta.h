@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// run-length encoded xor of two equally sized word arrays, stored as
+// (unchanged word count, changed word count, xor of each changed word...) runs
+// so the size is proportional to the number of words that differ
+std::vector<uint8_t> encode_delta(
+  const std::vector<uint64_t>& from, const std::vector<uint64_t>& to);
+// whether delta decodes to runs within words words, for deltas read from a
+// file before they're applied
+bool check_delta(const uint8_t* delta, size_t size, size_t words);
+// xors an encoded delta into words (applying it twice is a no-op)
+void apply_delta(
+  std::vector<uint64_t>& words, const uint8_t* delta, size_t size);
+
+inline void apply_delta(
+  std::vector<uint64_t>& words, const std::vector<uint8_t>& delta) {
+  apply_delta(words, delta.data(), delta.size());
+}
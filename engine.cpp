@@ -0,0 +1,507 @@
+#include "engine.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+  // maps a 4x4 neighborhood (bits 0-3 first row, 4-7 second row...) to the
+  // next state of its center 2x2 block (bits 0-1 top row, 2-3 bottom row),
+  // built once at startup
+  std::array<uint8_t, 65536> build_lut() {
+    // neighbors of the center cell (1, 1), shifted for the other three
+    constexpr uint32_t neighbors = 0b0111'0101'0111;
+    std::array<uint8_t, 65536> lut;
+    for (uint32_t index = 0; index < 65536; index++) {
+      uint8_t result = 0;
+      for (int32_t y = 0; y < 2; y++) {
+        for (int32_t x = 0; x < 2; x++) {
+          const int32_t shift = y * 4 + x;
+          const int32_t count = std::popcount(index & (neighbors << shift));
+          const bool alive = (index >> (shift + 5)) & 1;
+          result |= uint8_t(count == 3 || (count == 2 && alive)) << (y * 2 + x);
+        }
+      }
+      lut[index] = result;
+    }
+    return lut;
+  }
+
+  const std::array<uint8_t, 65536> g_lut = build_lut();
+
+#if defined(__SSE2__) || defined(_M_X64)
+  // moves the 64 ages of a board word on a generation, given the word's new
+  // cells, 16 ages at a time with saturating byte arithmetic
+  void age_word(uint8_t* ages, const uint64_t alive) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lanes[4];
+    __m128i any = _mm_cvtsi64_si128(int64_t(alive));
+    for (int32_t lane = 0; lane < 4; lane++) {
+      lanes[lane] =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(ages + lane * 16));
+      any = _mm_or_si128(any, lanes[lane]);
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) == 0xffff) {
+      return; // dead and faded, the common case on a sparse board
+    }
+
+    // byte b of alive repeated over bytes 8b to 8b + 7, then each byte
+    // compared against its own bit
+    const __m128i bytes = _mm_unpacklo_epi8(
+      _mm_cvtsi64_si128(int64_t(alive)), _mm_cvtsi64_si128(int64_t(alive)));
+    const __m128i low = _mm_unpacklo_epi16(bytes, bytes);
+    const __m128i high = _mm_unpackhi_epi16(bytes, bytes);
+    const __m128i repeated[4] = {
+      _mm_unpacklo_epi32(low, low), _mm_unpackhi_epi32(low, low),
+      _mm_unpacklo_epi32(high, high), _mm_unpackhi_epi32(high, high)};
+    const __m128i bits = _mm_set_epi8(
+      -128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+    const __m128i live_floor = _mm_set1_epi8(char(age_alive));
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i fade = _mm_set1_epi8(age_fade);
+    const __m128i trail = _mm_set1_epi8(age_trail);
+    for (int32_t lane = 0; lane < 4; lane++) {
+      const __m128i now =
+        _mm_cmpeq_epi8(_mm_and_si128(repeated[lane], bits), bits);
+      const __m128i age = lanes[lane];
+      // a cell born this generation counts up from age_alive, one that died
+      // fades from at least age_alive and lands on age_trail
+      const __m128i lived = _mm_adds_epu8(_mm_max_epu8(age, live_floor), one);
+      const __m128i faded = _mm_min_epu8(_mm_subs_epu8(age, fade), trail);
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(ages + lane * 16),
+        _mm_or_si128(_mm_and_si128(now, lived), _mm_andnot_si128(now, faded)));
+    }
+  }
+#else
+  // 0xff in every byte whose bit is set in the index
+  std::array<uint64_t, 256> build_byte_masks() {
+    std::array<uint64_t, 256> masks;
+    for (uint32_t bits = 0; bits < 256; bits++) {
+      masks[bits] = 0;
+      for (int32_t bit = 0; bit < 8; bit++) {
+        masks[bits] |= uint64_t((bits >> bit) & 1) * 0xff << (bit * 8);
+      }
+    }
+    return masks;
+  }
+
+  const std::array<uint64_t, 256> g_byte_masks = build_byte_masks();
+
+  // 0xff in every byte with its high bit set in highs (and no other bits)
+  inline uint64_t widen_highs(const uint64_t highs) {
+    return highs | (highs - (highs >> 7));
+  }
+
+  // as above, 8 ages at a time in the bytes of a uint64_t
+  void age_word(uint8_t* ages, const uint64_t alive) {
+    constexpr uint64_t ones = 0x0101010101010101;
+    constexpr uint64_t highs = ones * age_alive;
+    uint64_t lanes[8];
+    std::memcpy(lanes, ages, sizeof(lanes));
+    uint64_t any = alive;
+    for (const uint64_t age : lanes) {
+      any |= age;
+    }
+    if (any == 0) {
+      return;
+    }
+    for (int32_t lane = 0; lane < 8; lane++) {
+      const uint64_t age = lanes[lane];
+      const uint64_t now = g_byte_masks[(alive >> (lane * 8)) & 0xff];
+      const uint64_t was = widen_highs(age & highs);
+      // live ages count up until they reach 0xff
+      const uint64_t saturated = ((age & ~highs) + ones) & age & highs;
+      const uint64_t older = age + ones - (saturated >> 7);
+      // trails count down by age_fade, stopping at 0
+      const uint64_t fading = (age | highs) - ones * age_fade;
+      const uint64_t faded = fading & ~highs & widen_highs(fading & highs);
+      const uint64_t lived = (older & was) | (ones * (age_alive | 1) & ~was);
+      const uint64_t trail = (ones * age_trail & was) | (faded & ~was);
+      lanes[lane] = (lived & now) | (trail & ~now);
+    }
+    std::memcpy(ages, lanes, sizeof(lanes));
+  }
+#endif
+
+  // a pass over the whole board for the engines that don't age as they step
+  void age_board(engine_t& engine, const bitboard_t& board) {
+    if (!engine.track_ages_) {
+      return;
+    }
+    for (size_t offset = 0; offset < board.words_.size(); offset++) {
+      age_word(engine.ages_.data() + offset * 64, board.words_[offset]);
+    }
+  }
+
+  void step_reference(engine_t& engine, bitboard_t& board) {
+    if (
+      engine.reference_ == nullptr
+      || mc_gol_board_width(engine.reference_) != board.width_
+      || mc_gol_board_height(engine.reference_) != board.height_) {
+      if (engine.reference_ != nullptr) {
+        mc_gol_destroy_board(engine.reference_);
+      }
+      engine.reference_ = mc_gol_create_board(board.width_, board.height_);
+    }
+    apply_board(board, engine.reference_);
+    mc_gol_update_board(engine.reference_);
+    capture_board(board, engine.reference_);
+    mark_engine_board(engine);
+  }
+
+  // sizes next_ for board and fills the halo the output rows are read from
+  void begin_lut(engine_t& engine, const bitboard_t& board) {
+    if (
+      engine.next_.width_ != board.width_
+      || engine.next_.height_ != board.height_) {
+      engine.next_ = make_bitboard(board.width_, board.height_);
+    }
+    fill_halo(engine.halo_, board, engine.topology_);
+    mark_engine_board(engine); // the sparse board won't see this generation
+  }
+
+  // output rows begin (even) to end of the next generation into next_
+  void step_lut_rows(
+    engine_t& engine, const bitboard_t& board, const int32_t begin,
+    const int32_t end) {
+    const int32_t width = board.width_;
+    const int32_t height = board.height_;
+    // ages move on with each output word while it's still in registers
+    uint8_t* ages = engine.track_ages_ ? engine.ages_.data() : nullptr;
+
+    const uint64_t last_mask =
+      width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1;
+    // stripes of two output rows, read from the four padded rows around them
+    // (padded row top is the halo row above board row top)
+    for (int32_t top = begin; top < end; top += 2) {
+      const uint64_t* rows[4];
+      for (int32_t i = 0; i < 4; i++) {
+        rows[i] = halo_row(engine.halo_, top + i);
+      }
+      uint64_t* out_top = engine.next_.words_.data() + top * board.stride_;
+      uint64_t* out_bottom =
+        top + 1 < height ? out_top + board.stride_ : nullptr;
+      for (int32_t word = 0; word < board.stride_; word++) {
+        // windows[i] holds padded bits from 64 * word onwards of row i, the
+        // 4x4 neighborhood of output cells 2k, 2k + 1 starts at bit 2k
+        uint64_t windows[4];
+        uint64_t nexts[4];
+        for (int32_t i = 0; i < 4; i++) {
+          windows[i] = rows[i][word];
+          nexts[i] = rows[i][word + 1];
+        }
+        uint64_t top_bits = 0;
+        uint64_t bottom_bits = 0;
+        for (int32_t block = 0; block < 32; block++) {
+          const uint32_t index = uint32_t(windows[0] & 0xf)
+                               | uint32_t(windows[1] & 0xf) << 4
+                               | uint32_t(windows[2] & 0xf) << 8
+                               | uint32_t(windows[3] & 0xf) << 12;
+          const uint64_t result = g_lut[index];
+          top_bits |= (result & 3) << (block * 2);
+          bottom_bits |= (result >> 2) << (block * 2);
+          for (int32_t i = 0; i < 4; i++) {
+            windows[i] = (windows[i] >> 2) | (nexts[i] << 62);
+            nexts[i] >>= 2;
+          }
+        }
+        const uint64_t mask =
+          word == board.stride_ - 1 ? last_mask : ~uint64_t(0);
+        out_top[word] = top_bits & mask;
+        if (out_bottom != nullptr) {
+          out_bottom[word] = bottom_bits & mask;
+        }
+        if (ages != nullptr) {
+          uint8_t* ages_top = ages + (top * board.stride_ + word) * 64;
+          age_word(ages_top, top_bits & mask);
+          if (out_bottom != nullptr) {
+            age_word(ages_top + board.stride_ * 64, bottom_bits & mask);
+          }
+        }
+      }
+    }
+  }
+
+  void step_lut(engine_t& engine, bitboard_t& board) {
+    begin_lut(engine, board);
+    step_lut_rows(engine, board, 0, board.height_);
+    std::swap(board.words_, engine.next_.words_);
+  }
+
+  // copies the cells of row y that differ from the sparse board into it
+  void sync_sparse_row(engine_t& engine, const bitboard_t& board, int32_t y) {
+    sparse_board_t& sparse = engine.sparse_;
+    for (int32_t word = 0; word < board.stride_; word++) {
+      const int32_t left = word * 64;
+      const int32_t bits = std::min(64, board.width_ - left);
+      uint64_t known = 0;
+      for (int32_t bit = 0; bit < bits; bit++) {
+        if (sparse_cell(sparse, left + bit, y)) {
+          known |= uint64_t(1) << bit;
+        }
+      }
+      const uint64_t cells = board.words_[size_t(y) * board.stride_ + word];
+      for (uint64_t edited = cells ^ known; edited != 0;
+           edited &= edited - 1) {
+        const int32_t bit = std::countr_zero(edited);
+        set_sparse_cell(sparse, left + bit, y, (cells >> bit & 1) != 0);
+      }
+    }
+  }
+
+  // brings the sparse board up to date with the bitboard: a stale one is
+  // rebuilt from the live cells, otherwise only the rows marked as edited are
+  // compared
+  void sync_sparse(engine_t& engine, const bitboard_t& board) {
+    sparse_board_t& sparse = engine.sparse_;
+    if (
+      engine.stale_ || sparse.width_ != board.width_
+      || sparse.height_ != board.height_
+      || sparse.topology_ != engine.topology_) {
+      sparse = make_sparse_board(board.width_, board.height_, engine.topology_);
+      for (int32_t y = 0; y < board.height_; y++) {
+        for (int32_t word = 0; word < board.stride_; word++) {
+          for (uint64_t live = board.words_[size_t(y) * board.stride_ + word];
+               live != 0; live &= live - 1) {
+            const int32_t x = word * 64 + std::countr_zero(live);
+            set_sparse_cell(sparse, x, y, true);
+          }
+        }
+      }
+    } else {
+      std::vector<int32_t>& rows = engine.marked_rows_;
+      std::sort(rows.begin(), rows.end());
+      rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+      for (const int32_t y : rows) {
+        if (y < board.height_) {
+          sync_sparse_row(engine, board, y);
+        }
+      }
+    }
+    engine.marked_rows_.clear();
+    engine.stale_ = false;
+  }
+
+  // the sparse board is stepped and only the cells it flipped are written
+  // back, so a generation costs O(changes) while nothing else edits the board
+  void step_sparse_engine(engine_t& engine, bitboard_t& board) {
+    sync_sparse(engine, board);
+    sparse_board_t& sparse = engine.sparse_;
+    step_sparse(sparse);
+    for (const uint64_t key : sparse.changed_) {
+      const int32_t x = sparse_key_x(key);
+      const size_t offset =
+        size_t(sparse_key_y(key)) * board.stride_ + (x >> 6);
+      const uint64_t bit = uint64_t(1) << (x & 63);
+      board.words_[offset] ^= bit;
+    }
+  }
+
+  void choose_automatic(engine_t& engine, const bitboard_t& board) {
+    // while stepping sparse its board keeps count, the lookup table reads
+    // every word each generation anyway
+    int64_t population = 0;
+    if (engine.stepping_sparse_) {
+      sync_sparse(engine, board);
+      population = engine.sparse_.population_;
+    } else {
+      population = bitboard_population(board);
+    }
+    const double density =
+      double(population) / (double(board.width_) * board.height_);
+    // the gap stops a board near the threshold switching every generation
+    if (density < sparse_density) {
+      engine.stepping_sparse_ = true;
+    } else if (density > sparse_density * 2.0) {
+      engine.stepping_sparse_ = false;
+    }
+  }
+
+  void step_automatic(engine_t& engine, bitboard_t& board) {
+    choose_automatic(engine, board);
+    if (engine.stepping_sparse_) {
+      step_sparse_engine(engine, board);
+      age_board(engine, board);
+    } else {
+      step_lut(engine, board);
+    }
+  }
+
+  void size_ages(engine_t& engine, const bitboard_t& board) {
+    if (!engine.track_ages_) {
+      engine.ages_.clear();
+      engine.aged_.clear();
+    } else if (engine.ages_.size() != board.words_.size() * 64) {
+      engine.ages_.assign(board.words_.size() * 64, 0);
+      engine.aged_.clear();
+    }
+  }
+
+} // namespace
+
+const char* engine_name(const engine_e engine) {
+  switch (engine) {
+    case engine_e::reference:
+      return "Reference";
+    case engine_e::lut:
+      return "Lookup table";
+    case engine_e::sparse:
+      return "Sparse";
+    case engine_e::automatic:
+      return "Automatic";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* engine_id(const engine_e engine) {
+  switch (engine) {
+    case engine_e::reference:
+      return "reference";
+    case engine_e::lut:
+      return "lut";
+    case engine_e::sparse:
+      return "sparse";
+    case engine_e::automatic:
+      return "auto";
+    default:
+      return "unknown";
+  }
+}
+
+bool find_engine(const char* id, engine_e& engine) {
+  for (int32_t kind = 0; kind < static_cast<int32_t>(engine_e::count);
+       kind++) {
+    if (std::strcmp(id, engine_id(static_cast<engine_e>(kind))) == 0) {
+      engine = static_cast<engine_e>(kind);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool engine_supports(const engine_e engine, const topology_e topology) {
+  return engine != engine_e::reference || topology == topology_e::torus;
+}
+
+void destroy_engine(engine_t& engine) {
+  if (engine.reference_ != nullptr) {
+    mc_gol_destroy_board(engine.reference_);
+    engine.reference_ = nullptr;
+  }
+}
+
+void step_engine(engine_t& engine, bitboard_t& board) {
+  assert(engine_supports(engine.kind_, engine.topology_));
+  cancel_engine_rows(engine);
+  size_ages(engine, board);
+  switch (engine.kind_) {
+    case engine_e::reference:
+      step_reference(engine, board);
+      age_board(engine, board);
+      break;
+    case engine_e::lut:
+      step_lut(engine, board);
+      break;
+    case engine_e::sparse:
+      step_sparse_engine(engine, board);
+      age_board(engine, board);
+      break;
+    case engine_e::automatic:
+      step_automatic(engine, board);
+      break;
+    default:
+      break;
+  }
+}
+
+bool step_engine_rows(
+  engine_t& engine, bitboard_t& board, const int32_t rows) {
+  assert(engine_supports(engine.kind_, engine.topology_));
+  if (
+    engine.next_.width_ != board.width_
+    || engine.next_.height_ != board.height_) {
+    cancel_engine_rows(engine); // the board was resized part way through
+  }
+  if (engine.row_ == 0 && engine.kind_ == engine_e::automatic) {
+    choose_automatic(engine, board);
+  }
+  if (
+    engine.kind_ != engine_e::lut
+    && (engine.kind_ != engine_e::automatic || engine.stepping_sparse_)) {
+    step_engine(engine, board);
+    return true;
+  }
+
+  size_ages(engine, board);
+  if (engine.row_ == 0) {
+    begin_lut(engine, board);
+  }
+  // whole stripes of two rows
+  const int32_t end =
+    std::min(board.height_, engine.row_ + (std::max(rows, 1) + 1) / 2 * 2);
+  if (engine.track_ages_ && end < board.height_) {
+    // the generation can still be cancelled, so keep the ages it moves on
+    if (engine.aged_.empty()) {
+      engine.aged_top_ = engine.row_;
+    }
+    const size_t row_ages = size_t(board.stride_) * 64;
+    engine.aged_.insert(
+      engine.aged_.end(), engine.ages_.begin() + engine.row_ * row_ages,
+      engine.ages_.begin() + end * row_ages);
+  }
+  step_lut_rows(engine, board, engine.row_, end);
+  engine.row_ = end;
+  if (end < board.height_) {
+    return false;
+  }
+  std::swap(board.words_, engine.next_.words_);
+  engine.row_ = 0;
+  engine.aged_.clear();
+  return true;
+}
+
+void mark_engine_rows(
+  engine_t& engine, const int32_t top, const int32_t bottom) {
+  if (engine.stale_) {
+    return; // every row is read back anyway
+  }
+  const int32_t first = std::max(top, 0);
+  // past about a row each, comparing the whole board is as quick
+  if (
+    int64_t(engine.marked_rows_.size()) + (bottom - first)
+    > engine.sparse_.height_) {
+    mark_engine_board(engine);
+    return;
+  }
+  for (int32_t y = first; y < bottom; y++) {
+    engine.marked_rows_.push_back(y);
+  }
+}
+
+void mark_engine_board(engine_t& engine) {
+  engine.marked_rows_.clear();
+  engine.stale_ = true;
+}
+
+void cancel_engine_rows(engine_t& engine) {
+  const size_t first = size_t(engine.aged_top_) * engine.next_.stride_ * 64;
+  if (
+    engine.row_ > 0 && !engine.aged_.empty()
+    && first + engine.aged_.size() <= engine.ages_.size()) {
+    std::copy(
+      engine.aged_.begin(), engine.aged_.end(), engine.ages_.begin() + first);
+  }
+  engine.aged_.clear();
+  engine.row_ = 0;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "bitboard.h"
+#include "sparse.h"
+#include "topology.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class engine_e {
+  reference, // mc_gol_update_board (torus only)
+  lut, // 4x4 -> 2x2 lookup table
+  sparse, // cells next to last generation's changes (see sparse_board_t)
+  automatic, // sparse below sparse_density, lookup table above
+  count
+};
+
+const char* engine_name(engine_e engine);
+const char* engine_id(engine_e engine); // command line name
+
+// looks up an engine by engine_id, false if there is no such engine
+bool find_engine(const char* id, engine_e& engine);
+
+bool engine_supports(engine_e engine, topology_e topology);
+
+// live cell fraction below which the automatic engine steps sparse, it goes
+// back to the lookup table above twice this, about where the two cost the
+// same for an active soup on a 1024x1024 board (compare with --bench)
+constexpr double sparse_density = 0.001;
+
+// ages_ holds a byte for every bit of the board's words while track_ages_ is
+// set, updated as each generation is stepped: a live cell is age_alive | the
+// generations it has been alive (saturating at 127), a dead cell the trail
+// left when it died, starting at age_trail and fading by age_fade a generation
+constexpr uint8_t age_alive = 0x80;
+constexpr uint8_t age_fade = 8;
+constexpr uint8_t age_trail = age_alive - age_fade; // above any faded trail
+
+inline int32_t live_age(uint8_t age) { // 0 for a cell painted alive
+  return (age & age_alive) != 0 ? age & ~age_alive : 0;
+}
+
+inline int32_t dead_trail(uint8_t age) { // 0 for a cell painted dead
+  return (age & age_alive) != 0 ? 0 : age;
+}
+
+// engine selection and the scratch memory it steps with
+struct engine_t {
+  engine_e kind_ = engine_e::lut;
+  topology_e topology_ = topology_e::torus;
+  mc_gol_board_t* reference_ = nullptr;
+  bitboard_t next_;
+  halo_board_t halo_;
+  // the sparse engine's own copy of the board, it only mirrors the bitboard
+  // (which the window, history and every other engine read) so boards are
+  // still limited to what a bitboard_t can hold
+  sparse_board_t sparse_;
+  // rows changed since it was last stepped (see mark_engine_rows) and whether
+  // it has to be rebuilt, after another engine stepped the board or it was
+  // replaced
+  std::vector<int32_t> marked_rows_;
+  bool stale_ = true;
+  bool stepping_sparse_ = false; // the automatic engine's current choice
+  std::vector<uint8_t> ages_;
+  bool track_ages_ = false;
+  int32_t row_ = 0; // rows of the generation step_engine_rows is part way into
+  // ages_ of rows [aged_top_, row_) from before that generation stepped them,
+  // put back if it's cancelled
+  std::vector<uint8_t> aged_;
+  int32_t aged_top_ = 0;
+};
+
+void destroy_engine(engine_t& engine);
+
+// advances board one generation, its edges joined by topology_ (which the
+// engine must support)
+void step_engine(engine_t& engine, bitboard_t& board);
+
+// steps at least rows more rows of the generation under way (starting one if
+// there is none), true once it's finished and board has moved on; only the
+// lookup table engine stops part way, the others step a whole generation
+// each call. board must not change until then (see cancel_engine_rows)
+bool step_engine_rows(engine_t& engine, bitboard_t& board, int32_t rows);
+
+// rows [top, bottom) of the board were changed other than by stepping it,
+// the sparse engine only reads these back into its own board before the next
+// generation. mark_engine_board is for a board replaced or changed throughout
+void mark_engine_rows(engine_t& engine, int32_t top, int32_t bottom);
+void mark_engine_board(engine_t& engine);
+
+// drops the generation step_engine_rows is part way into, after the board is
+// edited or the engine or topology changed, ages_ of the rows it already
+// stepped go back to where they were
+void cancel_engine_rows(engine_t& engine);
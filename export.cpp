@@ -0,0 +1,331 @@
+#include "export.h"
+#include "bounded_queue.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  constexpr uint8_t g_dead[4] = {84, 122, 171, 255};
+  constexpr uint8_t g_alive[4] = {242, 181, 105, 255};
+  constexpr size_t g_queue_capacity = 8;
+  constexpr size_t g_pool_size = g_queue_capacity + 2;
+
+  template<typename T>
+  struct frame_t {
+    int64_t generation_ = 0;
+    T data_;
+  };
+
+  using board_frame_t = frame_t<std::vector<uint64_t>>;
+  using byte_frame_t = frame_t<std::vector<uint8_t>>;
+
+  std::array<uint32_t, 256> build_crc_table() {
+    std::array<uint32_t, 256> table;
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int32_t k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      }
+      table[n] = c;
+    }
+    return table;
+  }
+
+  const std::array<uint32_t, 256> g_crc_table = build_crc_table();
+
+  uint32_t crc32(uint32_t crc, const uint8_t* data, const size_t size) {
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+      crc = g_crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+  }
+
+  uint32_t adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (size > 0) {
+      // largest run before b can overflow 32 bits
+      const size_t run = std::min(size, size_t(5552));
+      for (size_t i = 0; i < run; i++) {
+        a += data[i];
+        b += a;
+      }
+      a %= 65521;
+      b %= 65521;
+      data += run;
+      size -= run;
+    }
+    return (b << 16) | a;
+  }
+
+  void put_u32_be(std::vector<uint8_t>& bytes, const uint32_t value) {
+    for (int32_t shift = 24; shift >= 0; shift -= 8) {
+      bytes.push_back(uint8_t(value >> shift));
+    }
+  }
+
+  void put_chunk(
+    std::vector<uint8_t>& png, const char (&type)[5],
+    const std::vector<uint8_t>& data) {
+    put_u32_be(png, uint32_t(data.size()));
+    const size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    put_u32_be(png, crc32(0, png.data() + start, png.size() - start));
+  }
+
+  // 8-bit rgba png, the image data is deflated with stored (uncompressed)
+  // blocks so encoding is a copy plus the checksums
+  void encode_png(
+    const std::vector<uint8_t>& rgba, const int32_t width,
+    const int32_t height, std::vector<uint8_t>& png) {
+    const size_t row_size = size_t(width) * 4;
+    std::vector<uint8_t> raw;
+    raw.reserve((row_size + 1) * height);
+    for (int32_t y = 0; y < height; y++) {
+      raw.push_back(0); // no filter
+      const uint8_t* row = rgba.data() + row_size * y;
+      raw.insert(raw.end(), row, row + row_size);
+    }
+
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    size_t offset = 0;
+    do {
+      const size_t block = std::min(raw.size() - offset, size_t(65535));
+      zlib.push_back(offset + block == raw.size() ? 1 : 0);
+      zlib.push_back(uint8_t(block));
+      zlib.push_back(uint8_t(block >> 8));
+      zlib.push_back(uint8_t(~block));
+      zlib.push_back(uint8_t(~block >> 8));
+      zlib.insert(
+        zlib.end(), raw.begin() + offset, raw.begin() + offset + block);
+      offset += block;
+    } while (offset < raw.size());
+    put_u32_be(zlib, adler32(raw.data(), raw.size()));
+
+    std::vector<uint8_t> header;
+    put_u32_be(header, uint32_t(width));
+    put_u32_be(header, uint32_t(height));
+    header.insert(header.end(), {8, 6, 0, 0, 0}); // 8-bit rgba
+
+    png.clear();
+    png.insert(png.end(), {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'});
+    put_chunk(png, "IHDR", header);
+    put_chunk(png, "IDAT", zlib);
+    put_chunk(png, "IEND", {});
+  }
+
+  // bt.601 limited range planes after a FRAME marker
+  void encode_y4m(const std::vector<uint8_t>& rgba, std::vector<uint8_t>& out) {
+    const size_t pixels = rgba.size() / 4;
+    const char marker[] = "FRAME\n";
+    out.assign(marker, marker + sizeof(marker) - 1);
+    const size_t planes = out.size();
+    out.resize(planes + pixels * 3);
+    uint8_t* y_plane = out.data() + planes;
+    uint8_t* u_plane = y_plane + pixels;
+    uint8_t* v_plane = u_plane + pixels;
+    for (size_t i = 0; i < pixels; i++) {
+      const int32_t r = rgba[i * 4];
+      const int32_t g = rgba[i * 4 + 1];
+      const int32_t b = rgba[i * 4 + 2];
+      y_plane[i] = uint8_t(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+      u_plane[i] = uint8_t(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+      v_plane[i] = uint8_t(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+  }
+
+  // draws one row of cells then repeats it for the rest of the cell height
+  void rasterise(
+    const bitboard_t& layout, const std::vector<uint64_t>& words,
+    const int32_t cell_size, std::vector<uint8_t>& rgba) {
+    const size_t row_size = size_t(layout.width_) * cell_size * 4;
+    rgba.resize(row_size * layout.height_ * cell_size);
+    for (int32_t y = 0; y < layout.height_; y++) {
+      uint8_t* row = rgba.data() + row_size * y * cell_size;
+      const uint64_t* cells = words.data() + y * layout.stride_;
+      for (int32_t x = 0; x < layout.width_; x++) {
+        const bool alive = (cells[x >> 6] >> (x & 63)) & 1;
+        uint8_t* pixel = row + size_t(x) * cell_size * 4;
+        for (int32_t i = 0; i < cell_size; i++) {
+          std::memcpy(pixel + i * 4, alive ? g_alive : g_dead, 4);
+        }
+      }
+      for (int32_t i = 1; i < cell_size; i++) {
+        std::memcpy(row + row_size * i, row, row_size);
+      }
+    }
+  }
+
+} // namespace
+
+const char* export_format_id(const export_format_e format) {
+  switch (format) {
+    case export_format_e::png:
+      return "png";
+    case export_format_e::rgba:
+      return "rgba";
+    case export_format_e::y4m:
+      return "y4m";
+    default:
+      return "unknown";
+  }
+}
+
+bool find_export_format(const char* id, export_format_e& format) {
+  for (const export_format_e candidate :
+       {export_format_e::png, export_format_e::rgba, export_format_e::y4m}) {
+    if (std::strcmp(id, export_format_id(candidate)) == 0) {
+      format = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+export_result_t run_export(
+  const export_options_t& options, bitboard_t board, engine_t& engine) {
+  export_result_t result;
+  const int32_t width = board.width_ * options.cell_size_;
+  const int32_t height = board.height_ * options.cell_size_;
+  const bool to_stdout = options.path_ == "-";
+  if (to_stdout && options.format_ == export_format_e::png) {
+    return result; // one file per frame, there's no stream to write to
+  }
+
+  std::ofstream file;
+  if (options.format_ != export_format_e::png && !to_stdout) {
+    file.open(options.path_, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return result;
+    }
+  }
+  std::ostream& stream = to_stdout ? std::cout : file;
+  if (options.format_ == export_format_e::y4m) {
+    stream << "YUV4MPEG2 W" << width << " H" << height << " F"
+           << options.fps_ << ":1 Ip A1:1 C444\n";
+  }
+
+  bounded_queue_t<board_frame_t> boards(g_queue_capacity);
+  bounded_queue_t<byte_frame_t> pixels(g_queue_capacity);
+  bounded_queue_t<byte_frame_t> encoded(g_queue_capacity);
+  // buffers go back to a pool once a stage is done with them
+  bounded_queue_t<std::vector<uint64_t>> free_boards(g_pool_size);
+  bounded_queue_t<std::vector<uint8_t>> free_pixels(g_pool_size);
+  for (size_t i = 0; i < g_pool_size; i++) {
+    free_boards.push(std::vector<uint64_t>(board.words_.size()));
+    free_pixels.push(std::vector<uint8_t>());
+  }
+  // any failure closes every queue so all the stages unwind
+  const auto stop = [&] {
+    boards.close();
+    pixels.close();
+    encoded.close();
+    free_boards.close();
+    free_pixels.close();
+  };
+
+  std::thread raster_thread(
+    [&, layout = make_bitboard(board.width_, board.height_)] {
+      while (auto frame = boards.pop()) {
+        auto buffer = free_pixels.pop();
+        if (!buffer) {
+          break;
+        }
+        rasterise(layout, frame->data_, options.cell_size_, *buffer);
+        free_boards.push(std::move(frame->data_));
+        if (!pixels.push({frame->generation_, std::move(*buffer)})) {
+          break;
+        }
+      }
+      pixels.close();
+    });
+
+  std::thread encode_thread([&] {
+    while (auto frame = pixels.pop()) {
+      byte_frame_t out{.generation_ = frame->generation_, .data_ = {}};
+      switch (options.format_) {
+        case export_format_e::png:
+          encode_png(frame->data_, width, height, out.data_);
+          break;
+        case export_format_e::y4m:
+          encode_y4m(frame->data_, out.data_);
+          break;
+        default:
+          out.data_ = frame->data_;
+          break;
+      }
+      free_pixels.push(std::move(frame->data_));
+      if (!encoded.push(std::move(out))) {
+        break;
+      }
+    }
+    encoded.close();
+  });
+
+  bool written = true;
+  std::thread write_thread([&] {
+    while (auto frame = encoded.pop()) {
+      if (options.format_ == export_format_e::png) {
+        char name[32];
+        std::snprintf(
+          name, sizeof(name), "%06lld.png",
+          static_cast<long long>(frame->generation_));
+        std::ofstream png(
+          options.path_ + name, std::ios::binary | std::ios::trunc);
+        png.write(
+          reinterpret_cast<const char*>(frame->data_.data()),
+          frame->data_.size());
+        written = written && bool(png);
+      } else {
+        stream.write(
+          reinterpret_cast<const char*>(frame->data_.data()),
+          frame->data_.size());
+        written = written && bool(stream);
+      }
+      if (!written) {
+        stop();
+        break;
+      }
+      result.frames_++;
+    }
+  });
+
+  const auto begin = std::chrono::steady_clock::now();
+  for (int64_t generation = 0; generation <= options.last_; generation++) {
+    if (generation > 0) {
+      step_engine(engine, board);
+    }
+    if (generation < options.first_) {
+      continue;
+    }
+    auto buffer = free_boards.pop();
+    if (!buffer) {
+      break;
+    }
+    std::copy(board.words_.begin(), board.words_.end(), buffer->begin());
+    if (!boards.push({generation, std::move(*buffer)})) {
+      break;
+    }
+  }
+  boards.close();
+  raster_thread.join();
+  encode_thread.join();
+  write_thread.join();
+  stream.flush();
+  result.seconds_ = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+  result.written_ = written && bool(stream);
+  return result;
+}
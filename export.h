@@ -0,0 +1,36 @@
+#pragma once
+
+#include "bitboard.h"
+#include "engine.h"
+
+#include <cstdint>
+#include <string>
+
+enum class export_format_e {
+  png, // one file per generation, path_ is the file name prefix
+  rgba, // raw 8-bit rgba frames back to back
+  y4m // yuv4mpeg2 video (4:4:4)
+};
+
+const char* export_format_id(export_format_e format); // command line name
+bool find_export_format(const char* id, export_format_e& format);
+
+struct export_options_t {
+  export_format_e format_ = export_format_e::png;
+  std::string path_; // "-" writes rgba and y4m to stdout (not png)
+  int64_t first_ = 0; // generations first_ to last_ inclusive
+  int64_t last_ = 100;
+  int32_t cell_size_ = 4; // pixels per cell
+  int32_t fps_ = 30; // y4m frame rate
+};
+
+struct export_result_t {
+  int64_t frames_ = 0;
+  double seconds_ = 0.0;
+  bool written_ = false;
+};
+
+// steps board to last_ on the calling thread while rasterising, encoding and
+// writing each frame happen on a thread per stage, joined by bounded queues
+export_result_t run_export(
+  const export_options_t& options, bitboard_t board, engine_t& engine);
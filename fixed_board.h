@@ -0,0 +1,157 @@
+#pragma once
+
+#include "bitboard.h"
+#include "life_kernel.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// a board with its size and topology fixed at compile time, laid out as
+// bitboard_t (cell (x, y) is bit x % 64 of word x / 64 in row y) in a
+// std::array, so it never allocates and stepping it unrolls completely. for
+// the many small boards of demos and fuzzing, where the dynamic size of
+// mc_gol_board_t and bitboard_t keeps every loop a loop
+template<int32_t width, int32_t height, topology_e topology = topology_e::torus>
+struct fixed_board_t {
+  static_assert(width > 0 && height > 0);
+  static constexpr int32_t stride = (width + 63) / 64; // words per row
+  std::array<uint64_t, size_t(stride) * height> words_ = {};
+};
+
+namespace fixed_detail {
+
+  template<int32_t width, int32_t height, topology_e topology>
+  using padded_row_t = std::array<
+    uint64_t, size_t(fixed_board_t<width, height, topology>::stride) + 1>;
+
+  template<size_t size>
+  constexpr bool padded_bit(
+    const std::array<uint64_t, size>& row, const int32_t bit) {
+    return (row[bit >> 6] >> (bit & 63)) & 1;
+  }
+
+  template<size_t size>
+  constexpr void set_padded_bit(
+    std::array<uint64_t, size>& row, const int32_t bit, const bool alive) {
+    row[bit >> 6] |= uint64_t(alive) << (bit & 63);
+  }
+
+  // board row y shifted up a bit with its side ghosts, as fill_halo does
+  template<int32_t width, int32_t height, topology_e topology>
+  constexpr padded_row_t<width, height, topology> board_row(
+    const fixed_board_t<width, height, topology>& board, const int32_t y) {
+    constexpr int32_t stride = fixed_board_t<width, height, topology>::stride;
+    padded_row_t<width, height, topology> row = {};
+    uint64_t carry = 0;
+    for (int32_t word = 0; word < stride; word++) {
+      const uint64_t cells = board.words_[y * stride + word];
+      row[word] = (cells << 1) | carry;
+      carry = cells >> 63;
+    }
+    row[stride] = carry;
+    if constexpr (topology != topology_e::plane) {
+      const int32_t side =
+        topology == topology_e::cross_surface ? height - 1 - y : y;
+      const auto cell = [&board](const int32_t x, const int32_t y) {
+        return (board.words_[y * stride + (x >> 6)] >> (x & 63)) & 1;
+      };
+      set_padded_bit(row, 0, cell(width - 1, side));
+      set_padded_bit(row, width + 1, cell(0, side));
+    }
+    return row;
+  }
+
+  // padded row y from -1 (the ghost row above) to height (the one below)
+  template<int32_t width, int32_t height, topology_e topology>
+  constexpr padded_row_t<width, height, topology> padded_row(
+    const fixed_board_t<width, height, topology>& board, const int32_t y) {
+    if (y >= 0 && y < height) {
+      return board_row(board, y);
+    }
+    if constexpr (topology == topology_e::plane) {
+      return {};
+    } else {
+      const auto from = board_row(board, y < 0 ? height - 1 : 0);
+      if constexpr (topology == topology_e::torus) {
+        return from;
+      } else {
+        padded_row_t<width, height, topology> row = {};
+        for (int32_t bit = 0; bit <= width + 1; bit++) {
+          set_padded_bit(row, bit, padded_bit(from, width + 1 - bit));
+        }
+        return row;
+      }
+    }
+  }
+
+} // namespace fixed_detail
+
+template<int32_t width, int32_t height, topology_e topology>
+constexpr bool fixed_cell(
+  const fixed_board_t<width, height, topology>& board, const int32_t x,
+  const int32_t y) {
+  constexpr int32_t stride = fixed_board_t<width, height, topology>::stride;
+  return (board.words_[y * stride + (x >> 6)] >> (x & 63)) & 1;
+}
+
+template<int32_t width, int32_t height, topology_e topology>
+constexpr void set_fixed_cell(
+  fixed_board_t<width, height, topology>& board, const int32_t x,
+  const int32_t y, const bool alive) {
+  constexpr int32_t stride = fixed_board_t<width, height, topology>::stride;
+  uint64_t& word = board.words_[y * stride + (x >> 6)];
+  const uint64_t bit = uint64_t(1) << (x & 63);
+  word = alive ? word | bit : word & ~bit;
+}
+
+// advances board one generation, the rows and words of each row are unrolled
+// with fold expressions rather than left to the optimizer
+template<int32_t width, int32_t height, topology_e topology>
+constexpr void step_fixed(fixed_board_t<width, height, topology>& board) {
+  using board_t = fixed_board_t<width, height, topology>;
+  using fixed_detail::padded_row;
+  constexpr int32_t stride = board_t::stride;
+  constexpr uint64_t last_mask =
+    width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1;
+
+  board_t next;
+  auto above = padded_row(board, -1);
+  auto row = padded_row(board, 0);
+  const auto step_row = [&](const int32_t y) {
+    const auto below = padded_row(board, y + 1);
+    [&]<size_t... words>(std::index_sequence<words...>) {
+      ((next.words_[y * stride + words] =
+          life_word(
+            above[words], above[words + 1], row[words], row[words + 1],
+            below[words], below[words + 1])
+          & (words == stride - 1 ? last_mask : ~uint64_t(0))),
+       ...);
+    }(std::make_index_sequence<stride>());
+    above = row;
+    row = below;
+  };
+  [&]<size_t... ys>(std::index_sequence<ys...>) {
+    (step_row(int32_t(ys)), ...);
+  }(std::make_index_sequence<height>());
+  board = next;
+}
+
+// copies between a fixed board and a bitboard of the same size
+template<int32_t width, int32_t height, topology_e topology>
+bitboard_t fixed_to_bitboard(
+  const fixed_board_t<width, height, topology>& board) {
+  bitboard_t bitboard = make_bitboard(width, height);
+  std::copy(board.words_.begin(), board.words_.end(), bitboard.words_.begin());
+  return bitboard;
+}
+
+template<int32_t width, int32_t height, topology_e topology>
+void fixed_from_bitboard(
+  fixed_board_t<width, height, topology>& board, const bitboard_t& bitboard) {
+  std::copy(
+    bitboard.words_.begin(), bitboard.words_.end(), board.words_.begin());
+}
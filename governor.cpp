@@ -0,0 +1,50 @@
+#include "governor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+  // bounds the catch up after a stall so it doesn't spiral
+  double max_owed(const governor_t& governor) {
+    return std::max(governor.max_lag_ * governor.rate_, 1.0) + 1.0;
+  }
+
+} // namespace
+
+void reset_governor(governor_t& governor) {
+  governor.owed_ = 0.0;
+  governor.achieved_ = 0.0;
+  governor.measured_seconds_ = 0.0;
+  governor.measured_generations_ = 0;
+}
+
+int32_t advance_governor(governor_t& governor, const double delta_time) {
+  governor.owed_ += delta_time * governor.rate_;
+  governor.owed_ = std::min(governor.owed_, max_owed(governor));
+  const auto steps = static_cast<int32_t>(std::min(
+    std::floor(governor.owed_), static_cast<double>(governor.max_steps_)));
+  governor.owed_ -= steps;
+  return steps;
+}
+
+void settle_governor(
+  governor_t& governor, const int32_t steps, const int32_t generations) {
+  governor.owed_ = std::clamp(
+    governor.owed_ + (steps - generations), 0.0, max_owed(governor));
+}
+
+void measure_governor(
+  governor_t& governor, const double delta_time, const int32_t generations) {
+  governor.measured_seconds_ += delta_time;
+  governor.measured_generations_ += generations;
+  // long enough to see at least 16 generations at slow rates
+  if (
+    governor.measured_seconds_
+    >= std::max(0.5, 16.0 / std::max(governor.rate_, 1.0))) {
+    governor.achieved_ =
+      governor.measured_generations_ / governor.measured_seconds_;
+    governor.measured_seconds_ = 0.0;
+    governor.measured_generations_ = 0;
+  }
+}
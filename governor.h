@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+// fixed timestep pacing for the simulation, time is accumulated as
+// generations owed (rate * elapsed) so no fraction of a step is ever lost
+struct governor_t {
+  double rate_ = 10.0; // requested generations per second
+  double owed_ = 0.0; // generations due but not yet stepped
+  int32_t max_steps_ = 256; // per frame, a longer backlog is dropped
+  double max_lag_ = 0.25; // seconds of backlog kept when falling behind
+  // seconds of each frame spent stepping, a generation that doesn't fit is
+  // finished over the following frames (see step_engine_rows)
+  double budget_ = 0.008;
+  // achieved rate, measured over windows of half a second or more
+  double achieved_ = 0.0;
+  double measured_seconds_ = 0.0;
+  int64_t measured_generations_ = 0;
+};
+
+// forgets any backlog (after pausing or changing the board by hand)
+void reset_governor(governor_t& governor);
+
+// adds a frame of elapsed time and returns the generations to step this frame
+int32_t advance_governor(governor_t& governor, double delta_time);
+
+// owes again the steps advance_governor returned that didn't finish in the
+// frame's budget, generations finished beyond them (one carried over from an
+// earlier frame) are paid off
+void settle_governor(governor_t& governor, int32_t steps, int32_t generations);
+
+// counts generations actually stepped towards the achieved rate
+void measure_governor(
+  governor_t& governor, double delta_time, int32_t generations);
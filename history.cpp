@@ -0,0 +1,144 @@
+#include "history.h"
+#include "delta.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+  size_t keyframe_size(const history_keyframe_t& keyframe) {
+    return keyframe.words_.size() * sizeof(uint64_t);
+  }
+
+  // a board too big for a keyframe to fit the budget on its own is only
+  // sought through by deltas
+  bool keyframes_fit(const history_t& history, const bitboard_t& board) {
+    return board.words_.size() * sizeof(uint64_t) <= history.budget_;
+  }
+
+  void evict_oldest(history_t& history) {
+    history_entry_t& oldest = history.entries_.front();
+    history.used_ -= oldest.delta_.size();
+    history.first_generation_ = oldest.generation_;
+    history.first_version_ = oldest.version_;
+    history.first_++;
+    history.entries_.pop_front();
+    while (!history.keyframes_.empty()
+           && history.keyframes_.front().index_ < history.first_) {
+      history.used_ -= keyframe_size(history.keyframes_.front());
+      history.keyframes_.pop_front();
+    }
+  }
+
+  void truncate_after_cursor(history_t& history) {
+    while (history_head(history) > history.cursor_) {
+      history.used_ -= history.entries_.back().delta_.size();
+      history.entries_.pop_back();
+    }
+    while (!history.keyframes_.empty()
+           && history.keyframes_.back().index_ > history.cursor_) {
+      history.used_ -= keyframe_size(history.keyframes_.back());
+      history.keyframes_.pop_back();
+    }
+    history.head_ = history.view_;
+  }
+
+} // namespace
+
+void reset_history(
+  history_t& history, const bitboard_t& board, const int64_t generation) {
+  history.head_ = board;
+  history.view_ = board;
+  history.entries_.clear();
+  history.keyframes_.clear();
+  history.first_ = 0;
+  history.first_generation_ = generation;
+  history.first_version_ = ++history.version_;
+  history.cursor_ = 0;
+  history.used_ = 0;
+  if (keyframes_fit(history, board)) {
+    history.keyframes_.push_back({.index_ = 0, .words_ = board.words_});
+    history.used_ = keyframe_size(history.keyframes_.back());
+  }
+}
+
+void commit_history(
+  history_t& history, const bitboard_t& board, const int64_t generation) {
+  // nothing changed (e.g. a click that didn't flip any cells)
+  if (
+    generation == history_generation(history, history.cursor_)
+    && board.words_ == history.view_.words_) {
+    return;
+  }
+
+  if (history.cursor_ != history_head(history)) {
+    truncate_after_cursor(history);
+  }
+
+  history.entries_.push_back(
+    {.delta_ = encode_delta(history.head_.words_, board.words_),
+     .generation_ = generation,
+     .version_ = ++history.version_});
+  history.used_ += history.entries_.back().delta_.size();
+  history.head_ = board;
+  history.view_ = board;
+  history.cursor_ = history_head(history);
+
+  if (
+    history.cursor_ % history.keyframe_interval_ == 0
+    && keyframes_fit(history, board)) {
+    history.keyframes_.push_back(
+      {.index_ = history.cursor_, .words_ = board.words_});
+    history.used_ += keyframe_size(history.keyframes_.back());
+  }
+
+  // always keep the newest entry so the previous state can be reached
+  while (history.used_ > history.budget_ && history.entries_.size() > 1) {
+    evict_oldest(history);
+  }
+}
+
+const bitboard_t& seek_history(history_t& history, int64_t index) {
+  index = std::clamp(index, history.first_, history_head(history));
+
+  int64_t from = history.cursor_;
+  const auto nearest = std::min_element(
+    history.keyframes_.begin(), history.keyframes_.end(),
+    [index](const history_keyframe_t& lhs, const history_keyframe_t& rhs) {
+      return std::abs(lhs.index_ - index) < std::abs(rhs.index_ - index);
+    });
+  if (
+    nearest != history.keyframes_.end()
+    && std::abs(nearest->index_ - index) < std::abs(from - index)) {
+    history.view_.words_ = nearest->words_;
+    from = nearest->index_;
+  }
+
+  // entry i takes state first_ + i to first_ + i + 1 (and back again)
+  for (; from < index; from++) {
+    apply_delta(
+      history.view_.words_, history.entries_[from - history.first_].delta_);
+  }
+  for (; from > index; from--) {
+    apply_delta(
+      history.view_.words_, history.entries_[from - history.first_ - 1].delta_);
+  }
+  history.cursor_ = index;
+  return history.view_;
+}
+
+int64_t find_history_version(const history_t& history, const int64_t version) {
+  if (version == history.first_version_) {
+    return history.first_;
+  }
+  // versions grow with the index
+  const auto entry = std::lower_bound(
+    history.entries_.begin(), history.entries_.end(), version,
+    [](const history_entry_t& lhs, const int64_t rhs) {
+      return lhs.version_ < rhs;
+    });
+  if (entry == history.entries_.end() || entry->version_ != version) {
+    return -1;
+  }
+  return history.first_ + (entry - history.entries_.begin()) + 1;
+}
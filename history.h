@@ -0,0 +1,72 @@
+#pragma once
+
+#include "bitboard.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// one step of history, the xor of a state with the one before it (see
+// encode_delta), its size follows the number of 64 cell words that changed
+struct history_entry_t {
+  std::vector<uint8_t> delta_;
+  int64_t generation_ = 0; // generation of the state this entry produces
+  int64_t version_ = 0; // of the state this entry produces
+};
+
+// full copy of a state, bounds how many deltas a seek has to apply (none are
+// kept for a board bigger than the whole budget)
+struct history_keyframe_t {
+  int64_t index_ = 0;
+  std::vector<uint64_t> words_;
+};
+
+// rewind/undo timeline of recent board states kept within a memory budget,
+// states are addressed by an absolute index that keeps growing as new states
+// are committed and the oldest are evicted
+struct history_t {
+  bitboard_t head_; // newest state
+  bitboard_t view_; // state at cursor_
+  std::deque<history_entry_t> entries_; // entries_[i]: first_ + i -> + i + 1
+  std::deque<history_keyframe_t> keyframes_;
+  int64_t first_ = 0; // index of the oldest state still reachable
+  int64_t first_generation_ = 0;
+  int64_t first_version_ = 0;
+  // numbers every state committed (or reset to) and is never reused, unlike
+  // indices and generations which repeat after a rewind or an edit
+  int64_t version_ = 0;
+  int64_t cursor_ = 0; // index of the state in view_
+  size_t budget_ = 16 * 1024 * 1024; // bytes
+  size_t used_ = 0;
+  int32_t keyframe_interval_ = 64;
+};
+
+void reset_history(
+  history_t& history, const bitboard_t& board, int64_t generation);
+// adds board as the newest state, discarding any states after the cursor
+void commit_history(
+  history_t& history, const bitboard_t& board, int64_t generation);
+// moves the cursor to index and returns the state there, applying one delta per
+// state moved (from the cursor or the closest keyframe, whichever is nearer)
+const bitboard_t& seek_history(history_t& history, int64_t index);
+
+inline int64_t history_head(const history_t& history) {
+  return history.first_ + static_cast<int64_t>(history.entries_.size());
+}
+
+inline int64_t history_generation(const history_t& history, int64_t index) {
+  return index == history.first_
+         ? history.first_generation_
+         : history.entries_[index - history.first_ - 1].generation_;
+}
+
+inline int64_t history_version(const history_t& history, int64_t index) {
+  return index == history.first_
+         ? history.first_version_
+         : history.entries_[index - history.first_ - 1].version_;
+}
+
+// index of the state committed as version, -1 once it's been evicted or
+// discarded by a commit after a rewind
+int64_t find_history_version(const history_t& history, int64_t version);
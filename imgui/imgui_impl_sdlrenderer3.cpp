@@ -23,6 +23,7 @@
 // - Introduction, links and more at the top of imgui.cpp
 
 // CHANGELOG
+//  2026-10-19: Convert vertex colors once per draw list instead of once per draw command.
 //  2025-01-18: Use endian-dependent RGBA32 texture format, to match SDL_Color.
 //  2024-10-09: Expose selected render state in ImGui_ImplSDLRenderer3_RenderState, which you can access in 'void* platform_io.Renderer_RenderState' during draw callbacks.
 //  2024-07-01: Update for SDL3 api changes: SDL_RenderGeometryRaw() uint32 version was removed (SDL#9009).
@@ -52,7 +53,7 @@ struct ImGui_ImplSDLRenderer3_Data
 {
     SDL_Renderer*           Renderer;       // Main viewport's renderer
     SDL_Texture*            FontTexture;
-    ImVector<SDL_FColor>    ColorBuffer;
+    ImVector<SDL_FColor>    ColorBuffer;    // Vertex colors of the draw list being rendered
 
     ImGui_ImplSDLRenderer3_Data()   { memset((void*)this, 0, sizeof(*this)); }
 };
@@ -114,22 +115,22 @@ void ImGui_ImplSDLRenderer3_NewFrame()
         ImGui_ImplSDLRenderer3_CreateDeviceObjects();
 }
 
-// https://github.com/libsdl-org/SDL/issues/9009
-static int SDL_RenderGeometryRaw8BitColor(SDL_Renderer* renderer, ImVector<SDL_FColor>& colors_out, SDL_Texture* texture, const float* xy, int xy_stride, const SDL_Color* color, int color_stride, const float* uv, int uv_stride, int num_vertices, const void* indices, int num_indices, int size_indices)
+// SDL3 only takes SDL_FColor vertex colors (https://github.com/libsdl-org/SDL/issues/9009), so convert each draw list's
+// colors once and point every command of the list into them, rather than converting from each command's VtxOffset on.
+static const SDL_FColor* ImGui_ImplSDLRenderer3_ConvertColors(ImVector<SDL_FColor>& colors_out, const ImDrawList* draw_list)
 {
-    const Uint8* color2 = (const Uint8*)color;
-    colors_out.resize(num_vertices);
-    SDL_FColor* color3 = colors_out.Data;
-    for (int i = 0; i < num_vertices; i++)
+    const ImDrawVert* vtx_buffer = draw_list->VtxBuffer.Data;
+    const int vtx_count = draw_list->VtxBuffer.Size;
+    colors_out.resize(vtx_count);
+    for (int i = 0; i < vtx_count; i++)
     {
-        color3[i].r = color->r / 255.0f;
-        color3[i].g = color->g / 255.0f;
-        color3[i].b = color->b / 255.0f;
-        color3[i].a = color->a / 255.0f;
-        color2 += color_stride;
-        color = (const SDL_Color*)color2;
+        const SDL_Color* color = (const SDL_Color*)(const void*)&vtx_buffer[i].col;
+        colors_out.Data[i].r = color->r / 255.0f;
+        colors_out.Data[i].g = color->g / 255.0f;
+        colors_out.Data[i].b = color->b / 255.0f;
+        colors_out.Data[i].a = color->a / 255.0f;
     }
-    return SDL_RenderGeometryRaw(renderer, texture, xy, xy_stride, color3, sizeof(*color3), uv, uv_stride, num_vertices, indices, num_indices, size_indices);
+    return colors_out.Data;
 }
 
 void ImGui_ImplSDLRenderer3_RenderDrawData(ImDrawData* draw_data, SDL_Renderer* renderer)
@@ -185,6 +186,7 @@ void ImGui_ImplSDLRenderer3_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
         const ImDrawList* draw_list = draw_data->CmdLists[n];
         const ImDrawVert* vtx_buffer = draw_list->VtxBuffer.Data;
         const ImDrawIdx* idx_buffer = draw_list->IdxBuffer.Data;
+        const SDL_FColor* colors = ImGui_ImplSDLRenderer3_ConvertColors(bd->ColorBuffer, draw_list);
 
         for (int cmd_i = 0; cmd_i < draw_list->CmdBuffer.Size; cmd_i++)
         {
@@ -215,13 +217,13 @@ void ImGui_ImplSDLRenderer3_RenderDrawData(ImDrawData* draw_data, SDL_Renderer*
 
                 const float* xy = (const float*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, pos));
                 const float* uv = (const float*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, uv));
-                const SDL_Color* color = (const SDL_Color*)(const void*)((const char*)(vtx_buffer + pcmd->VtxOffset) + offsetof(ImDrawVert, col)); // SDL 2.0.19+
+                const SDL_FColor* color = colors + pcmd->VtxOffset;
 
                 // Bind texture, Draw
                 SDL_Texture* tex = (SDL_Texture*)pcmd->GetTexID();
-                SDL_RenderGeometryRaw8BitColor(renderer, bd->ColorBuffer, tex,
+                SDL_RenderGeometryRaw(renderer, tex,
                     xy, (int)sizeof(ImDrawVert),
-                    color, (int)sizeof(ImDrawVert),
+                    color, (int)sizeof(SDL_FColor),
                     uv, (int)sizeof(ImDrawVert),
                     draw_list->VtxBuffer.Size - pcmd->VtxOffset,
                     idx_buffer + pcmd->IdxOffset, pcmd->ElemCount, sizeof(ImDrawIdx));
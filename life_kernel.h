@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+// the next states of the cells side by side in the bit lanes of word_t (a
+// uint64_t or anything with the same bitwise operators), from the words
+// holding their eight neighbours in the same lanes. the neighbours are added
+// bit-sliced: a full adder per row of three, a half adder for the two beside
+// the cells, then the twos only matter as exactly one of them being set
+template<typename word_t>
+constexpr word_t life_lanes(
+  const word_t north_west, const word_t north, const word_t north_east,
+  const word_t west, const word_t cells, const word_t east,
+  const word_t south_west, const word_t south, const word_t south_east) {
+  const auto add3 = [](
+                      const word_t a, const word_t b, const word_t c,
+                      word_t& twos) {
+    twos = (a & b) | (c & (a ^ b));
+    return a ^ b ^ c;
+  };
+  word_t north_twos = {};
+  const word_t north_ones = add3(north_west, north, north_east, north_twos);
+  word_t south_twos = {};
+  const word_t south_ones = add3(south_west, south, south_east, south_twos);
+  const word_t side_ones = west ^ east;
+  const word_t side_twos = west & east;
+
+  word_t carry = {};
+  const word_t ones = add3(north_ones, south_ones, side_ones, carry);
+  // the neighbour count is ones + 2 * (the four twos), it's 2 or 3 when
+  // exactly one of the twos is set
+  const word_t pair_a = north_twos ^ south_twos;
+  const word_t pair_b = side_twos ^ carry;
+  const word_t one_two =
+    (pair_a ^ pair_b) & ~(north_twos & south_twos) & ~(side_twos & carry);
+  return one_two & (ones | cells);
+}
+
+// the next states of 64 cells from the three padded rows around them (laid
+// out as halo_board_t rows, bit x + 1 holds cell x), each given as the word
+// holding the cells and the word after it
+constexpr uint64_t life_word(
+  const uint64_t above, const uint64_t above_next, const uint64_t row,
+  const uint64_t row_next, const uint64_t below, const uint64_t below_next) {
+  // padded bit x is the west neighbour of cell x, x + 1 the cell itself
+  const auto center = [](const uint64_t word, const uint64_t next) {
+    return (word >> 1) | (next << 63);
+  };
+  const auto east = [](const uint64_t word, const uint64_t next) {
+    return (word >> 2) | (next << 62);
+  };
+  return life_lanes(
+    above, center(above, above_next), east(above, above_next), row,
+    center(row, row_next), east(row, row_next), below,
+    center(below, below_next), east(below, below_next));
+}
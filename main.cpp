@@ -2,25 +2,67 @@
 #define SDL_MAIN_USE_CALLBACKS
 #include <SDL3/SDL_main.h>
 
+#include "analyse.h"
+#include "batch.h"
+#include "bench.h"
+#include "bitboard.h"
+#include "census.h"
+#include "control.h"
+#include "engine.h"
+#include "export.h"
+#include "governor.h"
+#include "history.h"
 #include "imgui/imgui_impl_sdl3.h"
 #include "imgui/imgui_impl_sdlrenderer3.h"
+#include "pattern.h"
+#include "publisher.h"
+#include "record.h"
+#include "soup.h"
+#include "timeline.h"
+#include "verify.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <numeric>
+#include <sstream>
+#include <span>
+#include <vector>
 
 #include <as/as-math-ops.hpp>
 #include <imgui.h>
 #include <minimal-cmake-gol/gol.h>
 
-struct game_of_life_t {
-  mc_gol_board_t* board_ = nullptr;
-  double timer_ = 0.0;
-  float delay_ = 0.1f;
-  float cell_size_ = 15.0f;
-  bool additive_ = true;
-  bool simulating_ = true;
-  bool pressing_ = false;
+// where the board is drawn in render output pixels, only recomputed when the
+// window size, its pixel density or the zoom changes
+struct layout_t {
+  as::vec2 top_left_;
+  float cell_size_ = 0.0f; // pixels
+  float pixel_density_ = 1.0f; // pixels per window coordinate
+  // every grid line as one polyline, the joins run along the board edges
+  std::vector<SDL_FPoint> grid_points_;
+  uint8_t grid_alpha_ = 0; // fades to 0 as cells get too small to separate
+  bool dirty_ = true;
+};
+
+// cells [min_, max_)
+struct region_t {
+  as::vec2i min_;
+  as::vec2i max_;
+};
+
+struct selection_t {
+  as::vec2i anchor_; // cell the drag started on
+  region_t region_;
+  bool active_ = false;
+  bool dragging_ = false;
 };
 
 struct color_t {
@@ -30,6 +72,46 @@ struct color_t {
   uint8_t a;
 };
 
+// live cells by age and recently dead cells by trail, heat_levels of each
+constexpr int32_t heat_levels = 8;
+
+struct game_of_life_t {
+  bitboard_t board_;
+  engine_t engine_;
+  recorder_t recorder_;
+  history_t history_;
+  publisher_t publisher_;
+  std::unique_ptr<timeline_reader_t> timeline_;
+  std::unique_ptr<control_server_t> control_;
+  // batches taken from the socket, run in order, the front one waits while
+  // its step command's generations are stepped by the frame loop
+  std::deque<control_batch_t> control_batches_;
+  int64_t control_steps_ = 0; // generations the step command still waits on
+  bool control_waiting_ = false;
+  std::vector<SDL_FRect> cell_rects_;
+  std::array<std::vector<SDL_FRect>, heat_levels * 2> heat_rects_;
+  int64_t generation_ = 0; // of the board shown, a seek moves it back
+  int64_t stepped_ = 0; // generations stepped, the clock events are recorded on
+  governor_t governor_;
+  // how long committing the last generation the frame loop stepped took, the
+  // loop leaves that much of the budget for the next one
+  uint64_t commit_ns_ = 0;
+  float cell_size_ = 15.0f; // window coordinates, changed by zooming
+  layout_t layout_;
+  int32_t stamp_ = -1; // index into stamp_library(), -1 to paint cells
+  int32_t orientation_ = 0;
+  as::vec2i hover_ = {-1, -1}; // board cell under the cursor
+  selection_t selection_;
+  bitboard_t clipboard_;
+  bool pasting_ = false; // the clipboard follows the cursor until placed
+  soup_options_t soup_; // what Randomise fills with
+  analyse_options_t analyse_;
+  std::optional<analyse_result_t> analysis_; // from the last Analyse
+  bool additive_ = true;
+  bool simulating_ = true;
+  bool pressing_ = false;
+};
+
 // mutable globals
 static SDL_Window* g_window = nullptr;
 static SDL_Renderer* g_renderer = nullptr;
@@ -37,114 +119,1413 @@ static int64_t g_prev_ns = 0;
 
 // constants
 const as::vec2i screen_dimensions = as::vec2i{800, 600};
+const as::vec2i board_dimensions = as::vec2i{40, 27};
+const float min_cell_size = 1.0f;
+const float max_cell_size = 64.0f;
+// board words stepped between checks of the frame's stepping budget
+const int32_t slice_words = 1 << 14;
+// the grid fades out between these cell sizes (in pixels)
+const float grid_fade_begin = 8.0f;
+const float grid_fade_end = 3.0f;
 
-static void clear_board(mc_gol_board_t* board) {
-  for (int32_t y = 0, board_height = mc_gol_board_height(board);
-       y < board_height; y++) {
-    for (int32_t x = 0, board_width = mc_gol_board_width(board);
-         x < board_width; x++) {
-      mc_gol_set_board_cell(board, x, y, false);
-    }
+// zigzags across the rows then down the columns, so one SDL_RenderLines call
+// draws the whole grid
+static void build_grid(layout_t& layout, const bitboard_t& board) {
+  const float left = layout.top_left_.x;
+  const float top = layout.top_left_.y;
+  const float right = left + layout.cell_size_ * board.width_;
+  const float bottom = top + layout.cell_size_ * board.height_;
+  layout.grid_points_.clear();
+  for (int32_t y = 0; y <= board.height_; y++) {
+    const float line_y = top + y * layout.cell_size_;
+    const bool forward = y % 2 == 0;
+    layout.grid_points_.push_back({forward ? left : right, line_y});
+    layout.grid_points_.push_back({forward ? right : left, line_y});
+  }
+  for (int32_t x = 0; x <= board.width_; x++) {
+    const float line_x = left + x * layout.cell_size_;
+    const bool upward = x % 2 == 0;
+    layout.grid_points_.push_back({line_x, upward ? bottom : top});
+    layout.grid_points_.push_back({line_x, upward ? top : bottom});
   }
 }
 
-static as::vec2 board_top_left_corner(
-  mc_gol_board_t* board, const float cell_size) {
-  return as::vec2(
-    (static_cast<float>(screen_dimensions.x) * 0.5f)
-      - (mc_gol_board_width(board) * cell_size) * 0.5f,
-    (static_cast<float>(screen_dimensions.y) * 0.5f)
-      - (mc_gol_board_height(board) * cell_size) * 0.5f);
+// centers the board in the render output (at native resolution)
+static const layout_t& update_layout(game_of_life_t* game_of_life) {
+  layout_t& layout = game_of_life->layout_;
+  if (!layout.dirty_) {
+    return layout;
+  }
+  int width = 0;
+  int height = 0;
+  SDL_GetRenderOutputSize(g_renderer, &width, &height);
+  layout.pixel_density_ = SDL_GetWindowPixelDensity(g_window);
+  if (layout.pixel_density_ <= 0.0f) {
+    layout.pixel_density_ = 1.0f;
+  }
+  const bitboard_t& board = game_of_life->board_;
+  layout.cell_size_ = game_of_life->cell_size_ * layout.pixel_density_;
+  layout.top_left_ = as::vec2(
+    SDL_floorf((width - board.width_ * layout.cell_size_) * 0.5f),
+    SDL_floorf((height - board.height_ * layout.cell_size_) * 0.5f));
+  const float fade = std::clamp(
+    (layout.cell_size_ - grid_fade_end) / (grid_fade_begin - grid_fade_end),
+    0.0f, 1.0f);
+  layout.grid_alpha_ = static_cast<uint8_t>(fade * 255.0f);
+  if (layout.grid_alpha_ > 0) {
+    build_grid(layout, board);
+  }
+  layout.dirty_ = false;
+  return layout;
 }
 
-static void reset_board(mc_gol_board_t* board) {
+static void reset_board(bitboard_t& board) {
+  bitboard_t pattern;
   // gosper glider gun
-  mc_gol_set_board_cell(board, 2, 5, true);
-  mc_gol_set_board_cell(board, 2, 6, true);
-  mc_gol_set_board_cell(board, 3, 5, true);
-  mc_gol_set_board_cell(board, 3, 6, true);
-
-  mc_gol_set_board_cell(board, 12, 5, true);
-  mc_gol_set_board_cell(board, 12, 6, true);
-  mc_gol_set_board_cell(board, 12, 7, true);
-  mc_gol_set_board_cell(board, 13, 4, true);
-  mc_gol_set_board_cell(board, 13, 8, true);
-  mc_gol_set_board_cell(board, 14, 3, true);
-  mc_gol_set_board_cell(board, 14, 9, true);
-  mc_gol_set_board_cell(board, 15, 3, true);
-  mc_gol_set_board_cell(board, 15, 9, true);
-  mc_gol_set_board_cell(board, 16, 6, true);
-  mc_gol_set_board_cell(board, 17, 4, true);
-  mc_gol_set_board_cell(board, 17, 8, true);
-  mc_gol_set_board_cell(board, 18, 5, true);
-  mc_gol_set_board_cell(board, 18, 6, true);
-  mc_gol_set_board_cell(board, 18, 7, true);
-  mc_gol_set_board_cell(board, 19, 6, true);
-
-  mc_gol_set_board_cell(board, 22, 3, true);
-  mc_gol_set_board_cell(board, 22, 4, true);
-  mc_gol_set_board_cell(board, 22, 5, true);
-  mc_gol_set_board_cell(board, 23, 3, true);
-  mc_gol_set_board_cell(board, 23, 4, true);
-  mc_gol_set_board_cell(board, 23, 5, true);
-  mc_gol_set_board_cell(board, 24, 2, true);
-  mc_gol_set_board_cell(board, 24, 6, true);
-  mc_gol_set_board_cell(board, 26, 1, true);
-  mc_gol_set_board_cell(board, 26, 2, true);
-  mc_gol_set_board_cell(board, 26, 6, true);
-  mc_gol_set_board_cell(board, 26, 7, true);
-
-  mc_gol_set_board_cell(board, 36, 3, true);
-  mc_gol_set_board_cell(board, 36, 4, true);
-  mc_gol_set_board_cell(board, 37, 3, true);
-  mc_gol_set_board_cell(board, 37, 4, true);
-
+  parse_rle(
+    "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4b"
+    "obo$10bo5bo7bo$11bo3bo$12b2o!",
+    pattern);
+  blit_bitboard(board, pattern, 2, 1);
   // eater
-  mc_gol_set_board_cell(board, 27, 20, true);
-  mc_gol_set_board_cell(board, 27, 21, true);
-  mc_gol_set_board_cell(board, 28, 20, true);
-  mc_gol_set_board_cell(board, 28, 21, true);
+  parse_rle("2o$2o3bo$4bobo$5bobo$7bo$7b2o!", pattern);
+  blit_bitboard(board, pattern, 27, 20);
+}
+
+static const char* find_arg(int argc, char** argv, const char* name) {
+  for (int i = 1; i < argc - 1; i++) {
+    if (SDL_strcmp(argv[i], name) == 0) {
+      return argv[i + 1];
+    }
+  }
+  return nullptr;
+}
+
+static bool has_arg(int argc, char** argv, const char* name) {
+  for (int i = 1; i < argc; i++) {
+    if (SDL_strcmp(argv[i], name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// the size of the default board, 40x27 unless --width or --height is given,
+// false if either isn't a positive number
+static bool find_board_size(int argc, char** argv, as::vec2i& size) {
+  size = board_dimensions;
+  if (const char* width = find_arg(argc, argv, "--width")) {
+    size.x = SDL_atoi(width);
+  }
+  if (const char* height = find_arg(argc, argv, "--height")) {
+    size.y = SDL_atoi(height);
+  }
+  if (size.x <= 0 || size.y <= 0) {
+    SDL_Log("Invalid board size: %dx%d", size.x, size.y);
+    return false;
+  }
+  return true;
+}
+
+static void record(
+  game_of_life_t* game_of_life, const record_event_e type,
+  const int32_t x = 0, const int32_t y = 0) {
+  record_event(
+    game_of_life->recorder_, record_event_t{
+                               .type_ = type,
+                               .generation_ = game_of_life->stepped_,
+                               .x_ = x,
+                               .y_ = y,
+                               .rate_ = float(game_of_life->governor_.rate_),
+                               .topology_ = game_of_life->engine_.topology_});
+}
+
+// adds the current board to the rewind history and publishes it to shared
+// memory (with --publish), a generation part way through is started again
+static void commit(game_of_life_t* game_of_life) {
+  cancel_engine_rows(game_of_life->engine_);
+  commit_history(
+    game_of_life->history_, game_of_life->board_, game_of_life->generation_);
+  publish_board(
+    game_of_life->publisher_, game_of_life->board_, game_of_life->generation_,
+    game_of_life->governor_.achieved_, SDL_GetTicksNS());
+}
+
+// replaces the board with another state (from the rewind history or a
+// timeline), the cells that change are recorded as paints so a replay doesn't
+// depend on where the state came from. a generation part way through was
+// stepping from the board being replaced, so it's started again
+static void show_board(game_of_life_t* game_of_life, const bitboard_t& view) {
+  cancel_engine_rows(game_of_life->engine_);
+  bitboard_t& board = game_of_life->board_;
+  for (int32_t y = 0; y < board.height_; y++) {
+    for (int32_t word = 0; word < board.stride_; word++) {
+      const size_t offset = y * board.stride_ + word;
+      if (board.words_[offset] != view.words_[offset]) {
+        mark_engine_rows(game_of_life->engine_, y, y + 1);
+      }
+      for (uint64_t changed = board.words_[offset] ^ view.words_[offset];
+           changed != 0; changed &= changed - 1) {
+        const int32_t x = word * 64 + std::countr_zero(changed);
+        const bool alive = bitboard_cell(view, x, y);
+        set_bitboard_cell(board, x, y, alive);
+        record(
+          game_of_life, alive ? record_event_e::cell_on
+                              : record_event_e::cell_off,
+          x, y);
+      }
+    }
+  }
+}
+
+// steps the default board without a window, streaming every generation to a
+// timeline file (the encoding and writing happens on another thread)
+static SDL_AppResult record_timeline(
+  const char* path, const as::vec2i size, const int64_t generations,
+  engine_t& engine) {
+  bitboard_t board = make_bitboard(size.x, size.y);
+  reset_board(board);
+
+  timeline_writer_t writer;
+  if (!begin_timeline(writer, path, board)) {
+    SDL_Log("Couldn't open timeline: %s", path);
+    return SDL_APP_FAILURE;
+  }
+  push_timeline(writer, board);
+
+  uint64_t recording_ns = 0;
+  const uint64_t begin_ns = SDL_GetTicksNS();
+  for (int64_t generation = 1; generation < generations; generation++) {
+    step_engine(engine, board);
+    const uint64_t push_ns = SDL_GetTicksNS();
+    push_timeline(writer, board);
+    recording_ns += SDL_GetTicksNS() - push_ns;
+  }
+  const uint64_t elapsed_ns = SDL_GetTicksNS() - begin_ns;
+
+  if (!end_timeline(writer)) {
+    SDL_Log("Couldn't write timeline: %s", path);
+    return SDL_APP_FAILURE;
+  }
+  SDL_Log(
+    "Recorded %lld generations in %.3fs (%.0f generations/s), recording took "
+    "%.1f%% of the simulation thread",
+    static_cast<long long>(generations), elapsed_ns * 1.0e-9,
+    elapsed_ns > 0 ? generations / (elapsed_ns * 1.0e-9) : 0.0,
+    elapsed_ns > 0 ? 100.0 * recording_ns / elapsed_ns : 0.0);
+  return SDL_APP_SUCCESS;
+}
+
+// renders generations of the default board to images or a video without a
+// window, "--output -" streams rgba and y4m to stdout (the log goes to stderr)
+static SDL_AppResult export_frames(int argc, char** argv, engine_t& engine) {
+  export_options_t options;
+  const char* format = find_arg(argc, argv, "--export");
+  if (!find_export_format(format, options.format_)) {
+    SDL_Log("Unknown export format: %s", format);
+    return SDL_APP_FAILURE;
+  }
+  if (const char* output = find_arg(argc, argv, "--output")) {
+    options.path_ = output;
+  }
+  if (const char* from = find_arg(argc, argv, "--from")) {
+    options.first_ = SDL_strtoll(from, nullptr, 10);
+  }
+  if (const char* to = find_arg(argc, argv, "--to")) {
+    options.last_ = SDL_strtoll(to, nullptr, 10);
+  }
+  if (const char* cell_size = find_arg(argc, argv, "--cell-size")) {
+    options.cell_size_ = SDL_atoi(cell_size);
+  }
+  if (const char* fps = find_arg(argc, argv, "--fps")) {
+    options.fps_ = SDL_atoi(fps);
+  }
+  if (
+    options.path_.empty() || options.first_ < 0
+    || options.last_ < options.first_ || options.cell_size_ <= 0
+    || options.fps_ <= 0) {
+    SDL_Log("Invalid export options");
+    return SDL_APP_FAILURE;
+  }
+  if (options.format_ == export_format_e::png && options.path_ == "-") {
+    SDL_Log("PNG frames are written to files, stdout takes rgba or y4m");
+    return SDL_APP_FAILURE;
+  }
+  as::vec2i size;
+  if (!find_board_size(argc, argv, size)) {
+    return SDL_APP_FAILURE;
+  }
+
+  bitboard_t board = make_bitboard(size.x, size.y);
+  reset_board(board);
+  const export_result_t result = run_export(options, board, engine);
+  if (!result.written_) {
+    SDL_Log("Couldn't write export: %s", options.path_.c_str());
+    return SDL_APP_FAILURE;
+  }
+  SDL_Log(
+    "Exported %lld frames (%s) in %.3fs, %.1f frames/s",
+    static_cast<long long>(result.frames_),
+    export_format_id(options.format_), result.seconds_,
+    result.seconds_ > 0.0 ? result.frames_ / result.seconds_ : 0.0);
+  return SDL_APP_SUCCESS;
+}
+
+// classifies the ash of random soups and prints the object counts
+static SDL_AppResult soup_census(int argc, char** argv) {
+  census_options_t options;
+  options.soups_ = SDL_strtoll(find_arg(argc, argv, "--census"), nullptr, 10);
+  if (const char* density = find_arg(argc, argv, "--density")) {
+    options.density_ = SDL_strtod(density, nullptr);
+  }
+  if (const char* seed = find_arg(argc, argv, "--seed")) {
+    options.seed_ = SDL_strtoull(seed, nullptr, 10);
+  }
+  if (const char* threads = find_arg(argc, argv, "--threads")) {
+    options.threads_ = SDL_atoi(threads);
+  }
+  if (const char* board_size = find_arg(argc, argv, "--board-size")) {
+    options.board_size_ = SDL_atoi(board_size);
+  }
+  if (const char* soup_size = find_arg(argc, argv, "--soup-size")) {
+    options.soup_size_ = SDL_atoi(soup_size);
+  }
+  if (
+    options.soups_ <= 0 || options.soup_size_ <= 0
+    || options.board_size_ < options.soup_size_) {
+    SDL_Log("Invalid census options");
+    return SDL_APP_FAILURE;
+  }
+
+  const census_result_t result = run_census(options);
+
+  std::vector<std::pair<std::string, int64_t>> counts(
+    result.counts_.begin(), result.counts_.end());
+  std::stable_sort(
+    counts.begin(), counts.end(),
+    [](const auto& lhs, const auto& rhs) { return lhs.second > rhs.second; });
+  for (const auto& [name, count] : counts) {
+    SDL_Log("%10lld %s", static_cast<long long>(count), name.c_str());
+  }
+  SDL_Log(
+    "%lld soups (%lld not stabilised) in %.3fs, %.1f soups/s",
+    static_cast<long long>(result.soups_),
+    static_cast<long long>(result.unstabilised_), result.seconds_,
+    result.seconds_ > 0.0 ? result.soups_ / result.seconds_ : 0.0);
+  return SDL_APP_SUCCESS;
+}
+
+// object counts, most common first
+static std::vector<std::pair<std::string, int64_t>> sorted_counts(
+  const analyse_result_t& analysis) {
+  std::vector<std::pair<std::string, int64_t>> counts(
+    analysis.counts_.begin(), analysis.counts_.end());
+  std::stable_sort(
+    counts.begin(), counts.end(),
+    [](const auto& lhs, const auto& rhs) { return lhs.second > rhs.second; });
+  return counts;
+}
+
+// steps a random soup without a window then splits what's left into objects
+// and prints how many there are of each
+static SDL_AppResult analyse_soup(int argc, char** argv, engine_t& engine) {
+  const int64_t generations =
+    SDL_strtoll(find_arg(argc, argv, "--analyse"), nullptr, 10);
+  int32_t width = 4096;
+  int32_t height = 4096;
+  soup_options_t soup;
+  soup.density_ = 0.35;
+  analyse_options_t options;
+  options.topology_ = engine.topology_;
+  if (const char* width_arg = find_arg(argc, argv, "--width")) {
+    width = SDL_atoi(width_arg);
+  }
+  if (const char* height_arg = find_arg(argc, argv, "--height")) {
+    height = SDL_atoi(height_arg);
+  }
+  if (const char* density = find_arg(argc, argv, "--density")) {
+    soup.density_ = SDL_strtod(density, nullptr);
+  }
+  if (const char* seed = find_arg(argc, argv, "--seed")) {
+    soup.seed_ = SDL_strtoull(seed, nullptr, 10);
+  }
+  if (const char* gap = find_arg(argc, argv, "--gap")) {
+    options.gap_ = SDL_atoi(gap);
+  }
+  if (const char* max_shapes = find_arg(argc, argv, "--max-shapes")) {
+    options.max_shapes_ = SDL_atoi(max_shapes);
+  }
+  if (const char* threads = find_arg(argc, argv, "--threads")) {
+    options.threads_ = SDL_atoi(threads);
+    soup.threads_ = options.threads_;
+  }
+  if (
+    generations < 0 || width <= 0 || height <= 0 || options.gap_ < 1
+    || options.max_shapes_ < 0 || options.threads_ < 0) {
+    SDL_Log("Invalid analyse options");
+    return SDL_APP_FAILURE;
+  }
+
+  bitboard_t board = make_bitboard(width, height);
+  fill_soup(board, soup);
+  for (int64_t generation = 0; generation < generations; generation++) {
+    step_engine(engine, board);
+  }
+  const analyse_result_t result = analyse_board(board, options);
+  SDL_Log(
+    "%lld objects in %.3fs (labelled in %.3fs)",
+    static_cast<long long>(result.objects_), result.seconds_,
+    result.label_seconds_);
+  for (const auto& [name, count] : sorted_counts(result)) {
+    SDL_Log("%10lld %s", static_cast<long long>(count), name.c_str());
+  }
+  return SDL_APP_SUCCESS;
+}
+
+// steps many small soups together with step_batch and prints the board
+// generations per second, then steps the first few one at a time with the
+// selected engine to check them and compare
+static SDL_AppResult step_soup_batch(
+  int argc, char** argv, engine_t& engine) {
+  const int32_t count = SDL_atoi(find_arg(argc, argv, "--batch"));
+  int32_t width = board_dimensions.x;
+  int32_t height = board_dimensions.y;
+  soup_options_t soup;
+  soup.density_ = 0.35;
+  soup.threads_ = 1;
+  batch_options_t options;
+  options.topology_ = engine.topology_;
+  if (const char* width_arg = find_arg(argc, argv, "--width")) {
+    width = SDL_atoi(width_arg);
+  }
+  if (const char* height_arg = find_arg(argc, argv, "--height")) {
+    height = SDL_atoi(height_arg);
+  }
+  if (const char* generations = find_arg(argc, argv, "--generations")) {
+    options.generations_ = SDL_atoi(generations);
+  }
+  if (const char* density = find_arg(argc, argv, "--density")) {
+    soup.density_ = SDL_strtod(density, nullptr);
+  }
+  if (const char* seed = find_arg(argc, argv, "--seed")) {
+    soup.seed_ = SDL_strtoull(seed, nullptr, 10);
+  }
+  if (const char* threads = find_arg(argc, argv, "--threads")) {
+    options.threads_ = SDL_atoi(threads);
+  }
+  if (
+    count <= 0 || width <= 0 || height <= 0 || options.generations_ < 0
+    || options.threads_ < 0) {
+    SDL_Log("Invalid batch options");
+    return SDL_APP_FAILURE;
+  }
+
+  // board i is the soup of seed + i
+  const auto make_soup = [&](const int32_t index) {
+    bitboard_t board = make_bitboard(width, height);
+    soup_options_t board_soup = soup;
+    board_soup.seed_ += uint64_t(index);
+    fill_soup(board, board_soup);
+    return board;
+  };
+  batch_t batch = make_batch(width, height, count);
+  for (int32_t index = 0; index < count; index++) {
+    set_batch_board(batch, index, make_soup(index));
+  }
+  const batch_stats_t stats = step_batch(batch, options);
+  const double board_generations =
+    static_cast<double>(count) * options.generations_;
+  const auto settled = std::count_if(
+    batch.settled_.begin(), batch.settled_.end(),
+    [](const int32_t generation) { return generation >= 0; });
+  SDL_Log(
+    "%d %dx%d boards, %d generations in %.3fs: %.4g board generations/s",
+    count, width, height, options.generations_, stats.seconds_,
+    board_generations / stats.seconds_);
+  SDL_Log(
+    "%lld settled, %lld of %lld group generations stepped",
+    static_cast<long long>(settled),
+    static_cast<long long>(stats.group_generations_),
+    static_cast<long long>(batch.groups_) * options.generations_);
+
+  const int32_t checked = std::min(count, 64);
+  bool matched = true;
+  const uint64_t begin_ns = SDL_GetTicksNS();
+  for (int32_t index = 0; index < checked; index++) {
+    bitboard_t board = make_soup(index);
+    mark_engine_board(engine);
+    for (int32_t generation = 0; generation < options.generations_;
+         generation++) {
+      step_engine(engine, board);
+    }
+    matched = matched && board.words_ == batch_board(batch, index).words_;
+  }
+  const double seconds = (SDL_GetTicksNS() - begin_ns) * 1.0e-9;
+  SDL_Log(
+    "%s engine, %d boards one at a time: %.4g board generations/s",
+    engine_name(engine.kind_), checked,
+    static_cast<double>(checked) * options.generations_ / seconds);
+  if (!matched) {
+    SDL_Log(
+      "The batch disagrees with the %s engine", engine_name(engine.kind_));
+    return SDL_APP_FAILURE;
+  }
+  return SDL_APP_SUCCESS;
+}
+
+// fills a board with a random soup without a window and prints how long it
+// took, with a hash of the cells to check a seed gives the same soup
+static SDL_AppResult fill_soup_board(int argc, char** argv) {
+  soup_options_t options;
+  options.density_ = SDL_strtod(find_arg(argc, argv, "--soup"), nullptr);
+  int32_t width = 32768;
+  int32_t height = 32768;
+  if (const char* width_arg = find_arg(argc, argv, "--width")) {
+    width = SDL_atoi(width_arg);
+  }
+  if (const char* height_arg = find_arg(argc, argv, "--height")) {
+    height = SDL_atoi(height_arg);
+  }
+  if (const char* seed = find_arg(argc, argv, "--seed")) {
+    options.seed_ = SDL_strtoull(seed, nullptr, 10);
+  }
+  if (const char* threads = find_arg(argc, argv, "--threads")) {
+    options.threads_ = SDL_atoi(threads);
+  }
+  if (
+    width <= 0 || height <= 0 || options.density_ < 0.0
+    || options.density_ > 1.0 || options.threads_ < 0) {
+    SDL_Log("Invalid soup options");
+    return SDL_APP_FAILURE;
+  }
+
+  bitboard_t board = make_bitboard(width, height);
+  const uint64_t begin_ns = SDL_GetTicksNS();
+  fill_soup(board, options);
+  const double seconds = (SDL_GetTicksNS() - begin_ns) * 1.0e-9;
+  const double cells = static_cast<double>(width) * height;
+  SDL_Log(
+    "Filled %dx%d in %.3fs (%.2f Gcells/s), %lld alive (%.4f) %016llx", width,
+    height, seconds, seconds > 0.0 ? cells / seconds * 1.0e-9 : 0.0,
+    static_cast<long long>(bitboard_population(board)),
+    bitboard_population(board) / cells,
+    static_cast<unsigned long long>(bitboard_hash(board)));
+  return SDL_APP_SUCCESS;
+}
+
+// steps a soup of the window's board size with mc_gol_update_board, the
+// lookup table engine and the fixed size board
+static SDL_AppResult benchmark_small_board(
+  int argc, char** argv, bench_options_t options) {
+  if (find_arg(argc, argv, "--generations") == nullptr) {
+    options.generations_ = 100000;
+  }
+  const std::vector<small_bench_result_t> results = run_small_bench(options);
+  bool matched = true;
+  for (const small_bench_result_t& result : results) {
+    matched = matched && result.hash_ == results.front().hash_;
+    SDL_Log(
+      "%-24s %12.1f generations/s %6.1fx %016llx", result.name_,
+      options.generations_ / result.seconds_,
+      results.front().seconds_ / result.seconds_,
+      static_cast<unsigned long long>(result.hash_));
+  }
+  if (!matched) {
+    SDL_Log("Small board steppers disagree on the final board");
+    return SDL_APP_FAILURE;
+  }
+  return SDL_APP_SUCCESS;
+}
+
+// steps a big soup with the lookup table engine then temporally blocked k
+// generations a pass for k from 1 to --max-depth, with the traffic to the
+// board each needed
+static SDL_AppResult benchmark_blocked(
+  int argc, char** argv, bench_options_t options) {
+  if (find_arg(argc, argv, "--width") == nullptr) {
+    options.width_ = 32768;
+  }
+  if (find_arg(argc, argv, "--height") == nullptr) {
+    options.height_ = 32768;
+  }
+  if (find_arg(argc, argv, "--generations") == nullptr) {
+    options.generations_ = 16;
+  }
+  int32_t max_depth = 8;
+  if (const char* depth = find_arg(argc, argv, "--max-depth")) {
+    max_depth = SDL_atoi(depth);
+  }
+  int32_t threads = 0;
+  if (const char* threads_arg = find_arg(argc, argv, "--threads")) {
+    threads = SDL_atoi(threads_arg);
+  }
+  if (max_depth <= 0 || threads < 0) {
+    SDL_Log("Invalid blocked benchmark options");
+    return SDL_APP_FAILURE;
+  }
+
+  const std::vector<blocked_bench_result_t> results =
+    run_blocked_bench(options, max_depth, threads);
+  const blocked_bench_result_t& lut = results.front();
+  SDL_Log(
+    "%-24s %10.2f generations/s %016llx", engine_name(engine_e::lut),
+    options.generations_ / lut.stats_.seconds_,
+    static_cast<unsigned long long>(lut.hash_));
+  const blocked_stats_t& single = results[1].stats_;
+  const auto traffic = [&options](const blocked_stats_t& stats) {
+    return static_cast<double>(stats.bytes_read_ + stats.bytes_written_)
+         / options.generations_;
+  };
+  bool matched = true;
+  for (size_t index = 1; index < results.size(); index++) {
+    const blocked_bench_result_t& result = results[index];
+    matched = matched && result.hash_ == lut.hash_;
+    const double rows = static_cast<double>(options.height_)
+                      * options.generations_;
+    SDL_Log(
+      "Blocked k=%-15d %10.2f generations/s %5.2fx %9.1f MB/generation "
+      "%5.2fx less %5.1f%% rows restepped %016llx",
+      result.depth_, options.generations_ / result.stats_.seconds_,
+      single.seconds_ / result.stats_.seconds_,
+      traffic(result.stats_) * 1.0e-6,
+      traffic(single) / traffic(result.stats_),
+      (result.stats_.rows_stepped_ / rows - 1.0) * 100.0,
+      static_cast<unsigned long long>(result.hash_));
+  }
+  if (!matched) {
+    SDL_Log("Blocked stepping disagrees with the lookup table engine");
+    return SDL_APP_FAILURE;
+  }
+  return SDL_APP_SUCCESS;
+}
+
+// steps the same random soup with every engine and compares their speed
+static SDL_AppResult benchmark_engines(int argc, char** argv) {
+  bench_options_t options;
+  if (const char* width = find_arg(argc, argv, "--width")) {
+    options.width_ = SDL_atoi(width);
+  }
+  if (const char* height = find_arg(argc, argv, "--height")) {
+    options.height_ = SDL_atoi(height);
+  }
+  if (const char* generations = find_arg(argc, argv, "--generations")) {
+    options.generations_ = SDL_atoi(generations);
+  }
+  if (const char* density = find_arg(argc, argv, "--density")) {
+    options.density_ = SDL_strtod(density, nullptr);
+  }
+  if (const char* seed = find_arg(argc, argv, "--seed")) {
+    options.seed_ = SDL_strtoull(seed, nullptr, 10);
+  }
+  if (
+    options.width_ <= 0 || options.height_ <= 0 || options.generations_ <= 0) {
+    SDL_Log("Invalid benchmark options");
+    return SDL_APP_FAILURE;
+  }
+
+  if (has_arg(argc, argv, "--small")) {
+    return benchmark_small_board(argc, argv, options);
+  }
+
+  if (has_arg(argc, argv, "--blocked")) {
+    return benchmark_blocked(argc, argv, options);
+  }
+
+  const double area = double(options.width_) * double(options.height_);
+  if (area > dense_bench_cells) {
+    if (!has_arg(argc, argv, "--density")) {
+      options.density_ = sparse_bench_density;
+    }
+    if (options.density_ * area > double(max_sparse_bench_cells)) {
+      SDL_Log(
+        "A soup of %.0f live cells is too many for the sparse engine, lower "
+        "--density",
+        options.density_ * area);
+      return SDL_APP_FAILURE;
+    }
+  }
+
+  const std::vector<bench_result_t> results = run_bench(options);
+  const double cells = static_cast<double>(options.width_) * options.height_
+                     * options.generations_;
+  bool matched = true;
+  for (const bench_result_t& result : results) {
+    matched = matched && result.hash_ == results.front().hash_;
+    SDL_Log(
+      "%-24s %10.1f generations/s %8.3f Gcells/s %016llx",
+      engine_name(result.engine_), options.generations_ / result.seconds_,
+      cells / result.seconds_ * 1.0e-9,
+      static_cast<unsigned long long>(result.hash_));
+  }
+  if (!matched) {
+    SDL_Log("Engines disagree on the final board");
+    return SDL_APP_FAILURE;
+  }
+  return SDL_APP_SUCCESS;
+}
+
+// checks every engine against mc_gol_update_board on patterns and soups, then
+// (with --baselines) their throughput against the last saved rates, the
+// first run saves them
+static SDL_AppResult verify_engines(int argc, char** argv) {
+  verify_options_t options;
+  if (const char* generations = find_arg(argc, argv, "--generations")) {
+    options.generations_ = SDL_atoi(generations);
+  }
+  if (const char* interval = find_arg(argc, argv, "--interval")) {
+    options.interval_ = SDL_atoi(interval);
+  }
+  if (const char* board_size = find_arg(argc, argv, "--board-size")) {
+    options.board_size_ = SDL_atoi(board_size);
+  }
+  if (const char* soups = find_arg(argc, argv, "--soups")) {
+    options.soups_ = SDL_atoi(soups);
+  }
+  if (const char* seed = find_arg(argc, argv, "--seed")) {
+    options.seed_ = SDL_strtoull(seed, nullptr, 10);
+  }
+  double tolerance = 0.3; // fraction of the baseline rate that may be lost
+  if (const char* value = find_arg(argc, argv, "--tolerance")) {
+    tolerance = SDL_strtod(value, nullptr);
+  }
+  if (
+    options.generations_ <= 0 || options.interval_ <= 0
+    || options.board_size_ <= 0 || options.soups_ < 0 || tolerance < 0.0) {
+    SDL_Log("Invalid verify options");
+    return SDL_APP_FAILURE;
+  }
+
+  const verify_result_t result = run_verify(options);
+  for (const verify_mismatch_t& mismatch : result.mismatches_) {
+    SDL_Log(
+      "%s disagrees with %s on %s (%s) by generation %lld",
+      mismatch.name_.c_str(), engine_name(mismatch.against_),
+      mismatch.case_.c_str(), topology_name(mismatch.topology_),
+      static_cast<long long>(mismatch.generation_));
+  }
+  SDL_Log(
+    "%d runs of %d generations, %d mismatched", result.runs_,
+    options.generations_, static_cast<int>(result.mismatches_.size()));
+  bool passed = result.mismatches_.empty();
+
+  // --save-baselines records the rates on this machine, --baselines checks
+  // them, an engine without one is reported but not checked
+  const char* save_path = find_arg(argc, argv, "--save-baselines");
+  const char* baselines_path = find_arg(argc, argv, "--baselines");
+  if (save_path == nullptr && baselines_path == nullptr) {
+    return passed ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+  }
+  std::map<std::string, double> baselines;
+  if (save_path == nullptr && !load_baselines(baselines_path, baselines)) {
+    SDL_Log(
+      "Couldn't load baselines: %s (record them with --save-baselines)",
+      baselines_path);
+    return SDL_APP_FAILURE;
+  }
+  const bench_options_t bench = {.width_ = 512, .height_ = 512};
+  const double cells =
+    static_cast<double>(bench.width_) * bench.height_ * bench.generations_;
+  for (const bench_result_t& run : run_bench(bench)) {
+    const double rate = cells / run.seconds_ * 1.0e-9;
+    if (save_path != nullptr) {
+      baselines[engine_id(run.engine_)] = rate;
+      SDL_Log("%-24s %8.3f Gcells/s", engine_name(run.engine_), rate);
+      continue;
+    }
+    const auto baseline = baselines.find(engine_id(run.engine_));
+    if (baseline == baselines.end()) {
+      SDL_Log(
+        "%-24s %8.3f Gcells/s (no baseline, skipped)",
+        engine_name(run.engine_), rate);
+      continue;
+    }
+    const bool fast_enough = rate >= baseline->second * (1.0 - tolerance);
+    passed = passed && fast_enough;
+    SDL_Log(
+      "%-24s %8.3f Gcells/s against %.3f%s", engine_name(run.engine_), rate,
+      baseline->second, fast_enough ? "" : " (REGRESSED)");
+  }
+  if (save_path != nullptr) {
+    if (!save_baselines(save_path, baselines)) {
+      SDL_Log("Couldn't save baselines: %s", save_path);
+      return SDL_APP_FAILURE;
+    }
+    SDL_Log("Saved baselines to %s", save_path);
+  }
+  return passed ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+}
+
+// re-runs a recorded session without a window as fast as the engine allows
+static SDL_AppResult replay_session(const char* path, engine_t& engine) {
+  recording_t recording;
+  if (!load_recording(path, recording)) {
+    SDL_Log("Couldn't load recording: %s", path);
+    return SDL_APP_FAILURE;
+  }
+
+  bitboard_t board = recording.initial_;
+
+  const uint64_t begin_ns = SDL_GetTicksNS();
+  int64_t generation = 0;
+  bool matched = false;
+  for (const record_event_t& event : recording.events_) {
+    for (; generation < event.generation_; generation++) {
+      step_engine(engine, board);
+    }
+    switch (event.type_) {
+      case record_event_e::cell_on:
+      case record_event_e::cell_off:
+        set_bitboard_cell(
+          board, event.x_, event.y_, event.type_ == record_event_e::cell_on);
+        mark_engine_rows(engine, event.y_, event.y_ + 1);
+        break;
+      case record_event_e::clear:
+        clear_bitboard(board);
+        mark_engine_board(engine);
+        break;
+      case record_event_e::restart:
+        clear_bitboard(board);
+        reset_board(board);
+        mark_engine_board(engine);
+        break;
+      case record_event_e::step:
+        step_engine(engine, board);
+        generation++;
+        break;
+      case record_event_e::topology:
+        if (!engine_supports(engine.kind_, event.topology_)) {
+          SDL_Log(
+            "%s engine can't replay a %s", engine_name(engine.kind_),
+            topology_name(event.topology_));
+          return SDL_APP_FAILURE;
+        }
+        engine.topology_ = event.topology_;
+        break;
+      case record_event_e::end:
+        matched = bitboard_hash(board) == event.hash_;
+        break;
+      default:
+        break;
+    }
+  }
+  const double elapsed = (SDL_GetTicksNS() - begin_ns) * 1.0e-9;
+
+  SDL_Log(
+    "Replayed %lld generations with %s in %.3fs (%.0f generations/s), final "
+    "board %s",
+    static_cast<long long>(generation), engine_name(engine.kind_), elapsed,
+    elapsed > 0.0 ? generation / elapsed : 0.0,
+    matched ? "matches" : "DOES NOT match");
+  return matched ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+}
 
-  mc_gol_set_board_cell(board, 32, 21, true);
-  mc_gol_set_board_cell(board, 31, 22, true);
-  mc_gol_set_board_cell(board, 33, 22, true);
-  mc_gol_set_board_cell(board, 32, 23, true);
+// board cell under a window position (which may be off the board)
+static as::vec2i cell_at(
+  game_of_life_t* game_of_life, const as::vec2& position) {
+  const layout_t& layout = update_layout(game_of_life);
+  const as::vec2 offset = position * layout.pixel_density_ - layout.top_left_;
+  return as::vec2i{
+    static_cast<int32_t>(SDL_floorf(offset.x / layout.cell_size_)),
+    static_cast<int32_t>(SDL_floorf(offset.y / layout.cell_size_))};
+}
+
+static bool on_board(const bitboard_t& board, const as::vec2i& cell) {
+  return cell.x >= 0 && cell.x < board.width_ && cell.y >= 0
+      && cell.y < board.height_;
+}
+
+// pattern following the cursor, the clipboard while pasting or a stamp
+static const bitboard_t* floating_pattern(const game_of_life_t* game_of_life) {
+  if (game_of_life->pasting_) {
+    return &game_of_life->clipboard_;
+  }
+  if (game_of_life->stamp_ >= 0) {
+    return &stamp_library()[game_of_life->stamp_]
+              .orientations_[game_of_life->orientation_];
+  }
+  return nullptr;
+}
+
+// top left cell of the floating pattern when centered on the hovered cell
+static as::vec2i floating_corner(
+  const game_of_life_t* game_of_life, const bitboard_t& pattern) {
+  return as::vec2i{
+    game_of_life->hover_.x - pattern.width_ / 2,
+    game_of_life->hover_.y - pattern.height_ / 2};
+}
+
+static region_t clip_region(const bitboard_t& board, const region_t& region) {
+  return region_t{
+    .min_ = {std::max(region.min_.x, 0), std::max(region.min_.y, 0)},
+    .max_ = {
+      std::min(region.max_.x, board.width_),
+      std::min(region.max_.y, board.height_)}};
+}
+
+static bool empty_region(const region_t& region) {
+  return region.max_.x <= region.min_.x || region.max_.y <= region.min_.y;
+}
+
+// runs an edit that only changes cells inside region, recording the cells it
+// changes so a replay doesn't depend on the clipboard or stamp library
+template<typename edit_fn>
+static void edit_region(
+  game_of_life_t* game_of_life, const region_t& region, edit_fn&& edit) {
+  bitboard_t& board = game_of_life->board_;
+  const region_t clipped = clip_region(board, region);
+  mark_engine_rows(game_of_life->engine_, clipped.min_.y, clipped.max_.y);
+  if (empty_region(clipped) || !recording(game_of_life->recorder_)) {
+    edit();
+    return;
+  }
+  const int32_t width = clipped.max_.x - clipped.min_.x;
+  const int32_t height = clipped.max_.y - clipped.min_.y;
+  const bitboard_t before =
+    extract_bitboard(board, clipped.min_.x, clipped.min_.y, width, height);
+  edit();
+  const bitboard_t after =
+    extract_bitboard(board, clipped.min_.x, clipped.min_.y, width, height);
+  for (int32_t y = 0; y < height; y++) {
+    for (int32_t word = 0; word < before.stride_; word++) {
+      const size_t offset = y * before.stride_ + word;
+      for (uint64_t changed = before.words_[offset] ^ after.words_[offset];
+           changed != 0; changed &= changed - 1) {
+        const int32_t x = word * 64 + std::countr_zero(changed);
+        record(
+          game_of_life,
+          bitboard_cell(after, x, y) ? record_event_e::cell_on
+                                     : record_event_e::cell_off,
+          clipped.min_.x + x, clipped.min_.y + y);
+      }
+    }
+  }
+}
+
+// fills the selection (or the whole board) with a random soup
+static void randomise(game_of_life_t* game_of_life) {
+  bitboard_t& board = game_of_life->board_;
+  const region_t region =
+    game_of_life->selection_.active_
+      ? clip_region(board, game_of_life->selection_.region_)
+      : region_t{.min_ = {0, 0}, .max_ = {board.width_, board.height_}};
+  if (empty_region(region)) {
+    return;
+  }
+  edit_region(game_of_life, region, [&] {
+    fill_soup(
+      board, region.min_.x, region.min_.y, region.max_.x - region.min_.x,
+      region.max_.y - region.min_.y, game_of_life->soup_);
+  });
+}
+
+// stamps are ored onto the board, a paste replaces the cells under it
+static void place_floating(game_of_life_t* game_of_life) {
+  bitboard_t& board = game_of_life->board_;
+  const bitboard_t& pattern = *floating_pattern(game_of_life);
+  const as::vec2i corner = floating_corner(game_of_life, pattern);
+  const region_t region = {
+    .min_ = corner,
+    .max_ = {corner.x + pattern.width_, corner.y + pattern.height_}};
+  const bool replace = game_of_life->pasting_;
+  edit_region(game_of_life, region, [&] {
+    const region_t clipped = clip_region(board, region);
+    if (replace && !empty_region(clipped)) {
+      clear_bitboard_region(
+        board, clipped.min_.x, clipped.min_.y,
+        clipped.max_.x - clipped.min_.x, clipped.max_.y - clipped.min_.y);
+    }
+    blit_bitboard(board, pattern, corner.x, corner.y);
+  });
+}
 
-  mc_gol_set_board_cell(board, 34, 23, true);
-  mc_gol_set_board_cell(board, 34, 24, true);
-  mc_gol_set_board_cell(board, 34, 25, true);
-  mc_gol_set_board_cell(board, 35, 25, true);
+static bitboard_t copy_selection(const game_of_life_t* game_of_life) {
+  const region_t& region = game_of_life->selection_.region_;
+  return extract_bitboard(
+    game_of_life->board_, region.min_.x, region.min_.y,
+    region.max_.x - region.min_.x, region.max_.y - region.min_.y);
+}
+
+// the clipboard is shared with other programs as rle
+static void copy_to_clipboard(game_of_life_t* game_of_life) {
+  game_of_life->clipboard_ = copy_selection(game_of_life);
+  SDL_SetClipboardText(write_rle(game_of_life->clipboard_).c_str());
+}
+
+static void clear_selection(game_of_life_t* game_of_life) {
+  const region_t region = game_of_life->selection_.region_;
+  edit_region(game_of_life, region, [&] {
+    clear_bitboard_region(
+      game_of_life->board_, region.min_.x, region.min_.y,
+      region.max_.x - region.min_.x, region.max_.y - region.min_.y);
+  });
+}
+
+// picks up rle from the system clipboard if there is any, otherwise pastes
+// whatever was copied last
+static void begin_paste(game_of_life_t* game_of_life) {
+  if (SDL_HasClipboardText()) {
+    char* text = SDL_GetClipboardText();
+    bitboard_t pattern;
+    const bitboard_t& board = game_of_life->board_;
+    if (parse_rle(text, pattern, board.width_, board.height_)) {
+      game_of_life->clipboard_ = std::move(pattern);
+    }
+    SDL_free(text);
+  }
+  if (game_of_life->clipboard_.width_ > 0) {
+    game_of_life->pasting_ = true;
+    game_of_life->stamp_ = -1;
+  }
+}
+
+// replaces the selection with an oriented copy anchored at its top left
+static void transform_selection(
+  game_of_life_t* game_of_life, const int32_t orientation) {
+  bitboard_t& board = game_of_life->board_;
+  region_t& region = game_of_life->selection_.region_;
+  const bitboard_t transformed =
+    orient_bitboard(copy_selection(game_of_life), orientation);
+  const region_t old_region = region;
+  region.max_ = {
+    region.min_.x + transformed.width_, region.min_.y + transformed.height_};
+  region = clip_region(board, region);
+  const region_t affected = {
+    .min_ = old_region.min_,
+    .max_ = {
+      std::max(old_region.max_.x, region.max_.x),
+      std::max(old_region.max_.y, region.max_.y)}};
+  edit_region(game_of_life, affected, [&] {
+    clear_bitboard_region(
+      board, old_region.min_.x, old_region.min_.y,
+      old_region.max_.x - old_region.min_.x,
+      old_region.max_.y - old_region.min_.y);
+    blit_bitboard(board, transformed, region.min_.x, region.min_.y);
+  });
+}
+
+// rotate and flip act on whatever is being edited
+static void rotate_edit(game_of_life_t* game_of_life) {
+  if (game_of_life->pasting_) {
+    game_of_life->clipboard_ = orient_bitboard(game_of_life->clipboard_, 1);
+  } else if (game_of_life->stamp_ >= 0) {
+    game_of_life->orientation_ =
+      rotate_orientation(game_of_life->orientation_);
+  } else if (game_of_life->selection_.active_) {
+    transform_selection(game_of_life, 1);
+    commit(game_of_life);
+  }
+}
+
+static void flip_edit(game_of_life_t* game_of_life) {
+  if (game_of_life->pasting_) {
+    game_of_life->clipboard_ = mirror_bitboard(game_of_life->clipboard_);
+  } else if (game_of_life->stamp_ >= 0) {
+    game_of_life->orientation_ = flip_orientation(game_of_life->orientation_);
+  } else if (game_of_life->selection_.active_) {
+    transform_selection(game_of_life, 4);
+    commit(game_of_life);
+  }
+}
+
+// drags out a selection between the anchor and the hovered cell
+static void update_selection(game_of_life_t* game_of_life) {
+  selection_t& selection = game_of_life->selection_;
+  const as::vec2i anchor = selection.anchor_;
+  const as::vec2i hover = game_of_life->hover_;
+  selection.region_ = clip_region(
+    game_of_life->board_,
+    region_t{
+      .min_ = {std::min(anchor.x, hover.x), std::min(anchor.y, hover.y)},
+      .max_ = {
+        std::max(anchor.x, hover.x) + 1, std::max(anchor.y, hover.y) + 1}});
+  selection.active_ = !empty_region(selection.region_);
 }
 
 static void toggle_cell(
   game_of_life_t* game_of_life, const as::vec2& position) {
-  const auto cell_size = game_of_life->cell_size_;
-  const auto top_left = board_top_left_corner(game_of_life->board_, cell_size);
-  const int32_t board_height = mc_gol_board_height(game_of_life->board_);
-  const int32_t board_width = mc_gol_board_width(game_of_life->board_);
-  for (int32_t y = 0; y < board_height; y++) {
-    for (int32_t x = 0; x < board_width; x++) {
-      const as::vec2 cell = top_left + as::vec2(x * cell_size, y * cell_size);
-      if (
-        position.x > cell.x && position.x <= cell.x + cell_size
-        && position.y > cell.y && position.y <= cell.y + cell_size) {
-        mc_gol_set_board_cell(
-          game_of_life->board_, x, y, game_of_life->additive_);
+  bitboard_t& board = game_of_life->board_;
+  const auto [x, y] = cell_at(game_of_life, position);
+  if (
+    !on_board(board, {x, y})
+    || bitboard_cell(board, x, y) == game_of_life->additive_) {
+    return;
+  }
+  set_bitboard_cell(board, x, y, game_of_life->additive_);
+  mark_engine_rows(game_of_life->engine_, y, y + 1);
+  // painting spans frames before it's committed
+  cancel_engine_rows(game_of_life->engine_);
+  record(
+    game_of_life,
+    game_of_life->additive_ ? record_event_e::cell_on
+                            : record_event_e::cell_off,
+    x, y);
+}
+
+// adds a rect for every live cell of pattern placed with its top left cell at
+// corner, skipping cells that fall outside board
+static void push_cell_rects(
+  std::vector<SDL_FRect>& cell_rects, const bitboard_t& pattern,
+  const as::vec2i& corner, const bitboard_t& board, const layout_t& layout) {
+  for (int32_t y = 0; y < pattern.height_; y++) {
+    const std::span<const uint64_t> row = bitboard_row(pattern, y);
+    for (size_t word = 0; word < row.size(); word++) {
+      for (uint64_t bits = row[word]; bits != 0; bits &= bits - 1) {
+        const as::vec2i cell = {
+          corner.x + static_cast<int32_t>(word * 64) + std::countr_zero(bits),
+          corner.y + y};
+        if (!on_board(board, cell)) {
+          continue;
+        }
+        cell_rects.push_back(SDL_FRect{
+          .x = layout.top_left_.x + cell.x * layout.cell_size_,
+          .y = layout.top_left_.y + cell.y * layout.cell_size_,
+          .w = layout.cell_size_,
+          .h = layout.cell_size_});
+      }
+    }
+  }
+}
+
+// sorts live cells into the first heat_levels lists by age and dead cells
+// with a trail into the rest by how faded it is, so every shade is drawn with
+// one batched call
+static void push_heat_rects(
+  std::array<std::vector<SDL_FRect>, heat_levels * 2>& heat_rects,
+  const bitboard_t& board, const std::vector<uint8_t>& ages,
+  const layout_t& layout) {
+  for (std::vector<SDL_FRect>& rects : heat_rects) {
+    rects.clear();
+  }
+  for (int32_t y = 0; y < board.height_; y++) {
+    const std::span<const uint64_t> row = bitboard_row(board, y);
+    for (size_t word = 0; word < row.size(); word++) {
+      const uint8_t* word_ages = ages.data() + (y * row.size() + word) * 64;
+      const int32_t cells =
+        std::min(64, board.width_ - static_cast<int32_t>(word * 64));
+      for (int32_t bit = 0; bit < cells; bit++) {
+        const uint8_t age = word_ages[bit];
+        const bool alive = (row[word] >> bit) & 1;
+        if (!alive && dead_trail(age) == 0) {
+          continue;
+        }
+        const int32_t level =
+          alive ? live_age(age) * heat_levels / 128
+                : heat_levels + dead_trail(age) * heat_levels / 128;
+        const int32_t x = static_cast<int32_t>(word * 64) + bit;
+        heat_rects[level].push_back(SDL_FRect{
+          .x = layout.top_left_.x + x * layout.cell_size_,
+          .y = layout.top_left_.y + y * layout.cell_size_,
+          .w = layout.cell_size_,
+          .h = layout.cell_size_});
+      }
+    }
+  }
+}
+
+static color_t mix_colors(
+  const color_t& from, const color_t& to, const float amount) {
+  const auto mix = [amount](const uint8_t lhs, const uint8_t rhs) {
+    return static_cast<uint8_t>(lhs + (rhs - lhs) * amount);
+  };
+  return color_t{
+    .r = mix(from.r, to.r),
+    .g = mix(from.g, to.g),
+    .b = mix(from.b, to.b),
+    .a = mix(from.a, to.a)};
+}
+
+static void step_board(game_of_life_t* game_of_life) {
+  step_engine(game_of_life->engine_, game_of_life->board_);
+  game_of_life->generation_++;
+  game_of_life->stepped_++;
+  commit(game_of_life);
+}
+
+// the version of the board shown, as the control socket reports it
+static std::string board_version(const game_of_life_t* game_of_life) {
+  const history_t& history = game_of_life->history_;
+  return std::to_string(game_of_life->generation_) + " "
+       + std::to_string(history_version(history, history.cursor_));
+}
+
+// the state committed as version, false if the rewind history no longer
+// holds it
+static bool history_state(
+  history_t& history, const int64_t version, bitboard_t& state) {
+  const int64_t index = find_history_version(history, version);
+  if (index < 0) {
+    return false;
+  }
+  const int64_t cursor = history.cursor_;
+  state = seek_history(history, index);
+  seek_history(history, cursor);
+  return true;
+}
+
+// the cells of a region as one line of rle (without the header)
+static std::string region_rle(const bitboard_t& region) {
+  const std::string rle = write_rle(region);
+  std::string line;
+  for (const char c : rle.substr(rle.find('\n') + 1)) {
+    if (c != '\n') {
+      line += c;
+    }
+  }
+  return line;
+}
+
+// runs one line from the control socket, the reply starts with ok or error.
+// step has no reply until its generations have been stepped
+static std::optional<std::string> run_control_command(
+  game_of_life_t* game_of_life, const std::string& command) {
+  std::istringstream stream(command);
+  std::string name;
+  stream >> name;
+  bitboard_t& board = game_of_life->board_;
+  if (name == "generation") {
+    return "ok " + std::to_string(game_of_life->generation_);
+  }
+  if (name == "population") {
+    return "ok " + std::to_string(bitboard_population(board));
+  }
+  if (name == "step") {
+    int64_t generations = 1;
+    stream >> generations;
+    if (!stream && !stream.eof()) {
+      return "error step takes a generation count";
+    }
+    if (generations < 1 || generations > 1'000'000) {
+      return "error step takes 1 to 1000000 generations";
+    }
+    game_of_life->control_steps_ = generations;
+    game_of_life->control_waiting_ = true;
+    return std::nullopt;
+  }
+  if (name == "run" || name == "pause") {
+    const bool simulating = name == "run";
+    if (game_of_life->simulating_ != simulating) {
+      reset_governor(game_of_life->governor_);
+      game_of_life->simulating_ = simulating;
+      record(
+        game_of_life,
+        simulating ? record_event_e::play : record_event_e::pause);
+    }
+    return "ok";
+  }
+  if (name == "rule") {
+    // every engine (and mc_gol) is hard wired for conway's rule
+    std::string rule;
+    stream >> rule;
+    std::transform(rule.begin(), rule.end(), rule.begin(), [](char c) {
+      return static_cast<char>(SDL_toupper(c));
+    });
+    return rule == "B3/S23" || rule == "23/3"
+           ? "ok"
+           : "error only B3/S23 is supported";
+  }
+  if (name == "clear") {
+    record(game_of_life, record_event_e::clear);
+    clear_bitboard(board);
+    mark_engine_board(game_of_life->engine_);
+    commit(game_of_life);
+    return "ok";
+  }
+  if (name == "load") {
+    as::vec2i corner;
+    std::string rle;
+    stream >> corner.x >> corner.y;
+    std::getline(stream >> std::ws, rle);
+    bitboard_t pattern;
+    if (!stream || !parse_rle(rle, pattern, board.width_, board.height_)) {
+      return "error load takes x y and a pattern in rle no bigger than the "
+             "board";
+    }
+    // the pattern may hang off the far edges, so the corner is bounded
+    // before anything is added to it
+    if (
+      corner.x < 0 || corner.y < 0 || corner.x >= board.width_
+      || corner.y >= board.height_) {
+      return "error load takes a corner on the board";
+    }
+    const region_t region = {
+      .min_ = corner,
+      .max_ = {corner.x + pattern.width_, corner.y + pattern.height_}};
+    edit_region(game_of_life, region, [&] {
+      blit_bitboard(board, pattern, corner.x, corner.y);
+    });
+    commit(game_of_life);
+    return "ok";
+  }
+  if (name == "region") {
+    region_t region;
+    int32_t width = 0;
+    int32_t height = 0;
+    stream >> region.min_.x >> region.min_.y >> width >> height;
+    region.max_ = {region.min_.x + width, region.min_.y + height};
+    if (
+      !stream || width <= 0 || height <= 0 || region.min_.x < 0
+      || region.min_.y < 0 || region.max_.x > board.width_
+      || region.max_.y > board.height_) {
+      return "error region takes x y width height on the board";
+    }
+    const std::string version = board_version(game_of_life);
+    const bitboard_t now =
+      extract_bitboard(board, region.min_.x, region.min_.y, width, height);
+    int64_t since = 0;
+    bitboard_t then;
+    if (
+      !(stream >> since)
+      || !history_state(game_of_life->history_, since, then)) {
+      return "ok full " + version + " " + region_rle(now);
+    }
+    // only the cells that flipped since the client's version
+    then = extract_bitboard(then, region.min_.x, region.min_.y, width, height);
+    std::string changes;
+    int64_t count = 0;
+    for (int32_t y = 0; y < height; y++) {
+      for (int32_t word = 0; word < now.stride_; word++) {
+        const size_t offset = y * now.stride_ + word;
+        for (uint64_t changed = now.words_[offset] ^ then.words_[offset];
+             changed != 0; changed &= changed - 1) {
+          const int32_t x = word * 64 + std::countr_zero(changed);
+          changes += " " + std::to_string(region.min_.x + x) + " "
+                   + std::to_string(region.min_.y + y);
+          count++;
+        }
+      }
+    }
+    return "ok changes " + version + " " + std::to_string(count) + changes;
+  }
+  return "error unknown command " + name;
+}
+
+// runs batches from the control socket in order, answering each once all its
+// commands have run, until one waits on a step command's generations
+static void run_control_batches(game_of_life_t* game_of_life) {
+  control_server_t& control = *game_of_life->control_;
+  std::deque<control_batch_t>& batches = game_of_life->control_batches_;
+  for (control_batch_t& batch : take_control_batches(control)) {
+    batches.push_back(std::move(batch));
+  }
+  while (!batches.empty()) {
+    control_batch_t& batch = batches.front();
+    if (game_of_life->control_waiting_) {
+      if (game_of_life->control_steps_ > 0) {
+        return;
       }
+      game_of_life->control_waiting_ = false;
+      batch.replies_.push_back("ok " + board_version(game_of_life));
     }
+    while (batch.replies_.size() < batch.commands_.size()) {
+      std::optional<std::string> reply = run_control_command(
+        game_of_life, batch.commands_[batch.replies_.size()]);
+      if (!reply) {
+        return;
+      }
+      batch.replies_.push_back(std::move(*reply));
+    }
+    answer_control_batch(control, std::move(batch));
+    batches.pop_front();
   }
 }
 
+// picks the engine and topology named with --engine and --topology
+// (engine_t's defaults otherwise)
+static bool select_engine(int argc, char** argv, engine_t& engine) {
+  const char* id = find_arg(argc, argv, "--engine");
+  if (id != nullptr && !find_engine(id, engine.kind_)) {
+    SDL_Log("Unknown engine: %s", id);
+    return false;
+  }
+  const char* topology = find_arg(argc, argv, "--topology");
+  if (topology != nullptr && !find_topology(topology, engine.topology_)) {
+    SDL_Log("Unknown topology: %s", topology);
+    return false;
+  }
+  if (!engine_supports(engine.kind_, engine.topology_)) {
+    SDL_Log(
+      "%s engine doesn't support a %s", engine_name(engine.kind_),
+      topology_name(engine.topology_));
+    return false;
+  }
+  return true;
+}
+
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv) {
   SDL_SetAppMetadata("Game of Life", "1.0", "com.minimal-cmake.game-of-life");
 
+  engine_t engine;
+  if (!select_engine(argc, argv, engine)) {
+    return SDL_APP_FAILURE;
+  }
+
+  if (const char* replay_path = find_arg(argc, argv, "--replay")) {
+    const SDL_AppResult result = replay_session(replay_path, engine);
+    destroy_engine(engine);
+    return result;
+  }
+
+  if (has_arg(argc, argv, "--verify")) {
+    return verify_engines(argc, argv);
+  }
+
+  if (has_arg(argc, argv, "--bench")) {
+    return benchmark_engines(argc, argv);
+  }
+
+  if (find_arg(argc, argv, "--census")) {
+    return soup_census(argc, argv);
+  }
+
+  if (find_arg(argc, argv, "--soup")) {
+    return fill_soup_board(argc, argv);
+  }
+
+  if (find_arg(argc, argv, "--analyse")) {
+    const SDL_AppResult result = analyse_soup(argc, argv, engine);
+    destroy_engine(engine);
+    return result;
+  }
+
+  if (find_arg(argc, argv, "--batch")) {
+    const SDL_AppResult result = step_soup_batch(argc, argv, engine);
+    destroy_engine(engine);
+    return result;
+  }
+
+  if (const char* timeline_path = find_arg(argc, argv, "--record-timeline")) {
+    as::vec2i size;
+    if (!find_board_size(argc, argv, size)) {
+      return SDL_APP_FAILURE;
+    }
+    const char* generations = find_arg(argc, argv, "--generations");
+    const SDL_AppResult result = record_timeline(
+      timeline_path, size,
+      generations ? SDL_strtoll(generations, nullptr, 10) : 1'000'000, engine);
+    destroy_engine(engine);
+    return result;
+  }
+
+  if (find_arg(argc, argv, "--export")) {
+    const SDL_AppResult result = export_frames(argc, argv, engine);
+    destroy_engine(engine);
+    return result;
+  }
+
+  as::vec2i board_size;
+  if (!find_board_size(argc, argv, board_size)) {
+    return SDL_APP_FAILURE;
+  }
+
   if (!SDL_Init(SDL_INIT_VIDEO)) {
     SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
     return SDL_APP_FAILURE;
   }
 
   if (!SDL_CreateWindowAndRenderer(
-        "Game of Life", 800, 600, 0, &g_window, &g_renderer)) {
+        "Game of Life", screen_dimensions.x, screen_dimensions.y,
+        SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY, &g_window,
+        &g_renderer)) {
     SDL_Log("Couldn't create window/renderer: %s", SDL_GetError());
     return SDL_APP_FAILURE;
   }
@@ -152,8 +1533,49 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv) {
   SDL_SetRenderVSync(g_renderer, 1); // enable vsync
 
   auto game_of_life = std::make_unique<game_of_life_t>();
-  game_of_life->board_ = mc_gol_create_board(40, 27);
-  reset_board(game_of_life->board_);
+  game_of_life->engine_ = engine;
+  if (const char* timeline_path = find_arg(argc, argv, "--view-timeline")) {
+    game_of_life->timeline_ = std::make_unique<timeline_reader_t>();
+    if (!open_timeline(*game_of_life->timeline_, timeline_path)) {
+      SDL_Log("Couldn't open timeline: %s", timeline_path);
+      return SDL_APP_FAILURE;
+    }
+    game_of_life->board_ = seek_timeline(*game_of_life->timeline_, 0);
+    game_of_life->generation_ = game_of_life->timeline_->generation_;
+    game_of_life->simulating_ = false;
+  } else {
+    game_of_life->board_ = make_bitboard(board_size.x, board_size.y);
+    reset_board(game_of_life->board_);
+  }
+  reset_history(
+    game_of_life->history_, game_of_life->board_, game_of_life->generation_);
+  if (const char* record_path = find_arg(argc, argv, "--record")) {
+    if (!begin_recording(
+          game_of_life->recorder_, record_path, game_of_life->board_)) {
+      SDL_Log("Couldn't open recording: %s", record_path);
+      return SDL_APP_FAILURE;
+    }
+    record(game_of_life.get(), record_event_e::topology);
+  }
+  if (const char* publish_name = find_arg(argc, argv, "--publish")) {
+    if (!open_publisher(
+          game_of_life->publisher_, publish_name, game_of_life->board_)) {
+      SDL_Log(
+        "Couldn't open shared memory %s: %s", publish_name,
+        std::strerror(errno));
+      return SDL_APP_FAILURE;
+    }
+    commit(game_of_life.get());
+  }
+  if (const char* control_path = find_arg(argc, argv, "--control")) {
+    game_of_life->control_ = std::make_unique<control_server_t>();
+    if (!open_control(*game_of_life->control_, control_path)) {
+      SDL_Log(
+        "Couldn't open control socket %s: %s", control_path,
+        std::strerror(errno));
+      return SDL_APP_FAILURE;
+    }
+  }
   *appstate = game_of_life.release();
 
   ImGui::CreateContext();
@@ -173,12 +1595,10 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
   g_prev_ns = now_ns;
 
   const double delta_time = delta_ticks_ns * 1.0e-9;
-  game_of_life->timer_ += delta_time;
 
-  const auto step_board = [game_of_life] {
-    mc_gol_update_board(game_of_life->board_);
-    game_of_life->timer_ = 0.0;
-  };
+  if (game_of_life->control_ != nullptr) {
+    run_control_batches(game_of_life);
+  }
 
   ImGui_ImplSDLRenderer3_NewFrame();
   ImGui_ImplSDL3_NewFrame();
@@ -188,78 +1608,366 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
   SDL_RenderClear(g_renderer);
 
   if (ImGui::Begin("Game of Life")) {
+    governor_t& governor = game_of_life->governor_;
     ImGui::PushItemWidth(100.0f);
-    ImGui::SliderFloat(
-      "Simulation time", &game_of_life->delay_, 0.01f, 1.0f, "%.2f",
-      ImGuiSliderFlags_AlwaysClamp);
+    const double min_rate = 1.0;
+    const double max_rate = 10000.0;
+    if (ImGui::SliderScalar(
+          "Generations/s", ImGuiDataType_Double, &governor.rate_, &min_rate,
+          &max_rate, "%.1f",
+          ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic)) {
+      record(game_of_life, record_event_e::rate);
+    }
+    float budget_ms = static_cast<float>(governor.budget_ * 1000.0);
+    if (ImGui::SliderFloat(
+          "Step budget (ms)", &budget_ms, 1.0f, 100.0f, "%.0f",
+          ImGuiSliderFlags_AlwaysClamp)) {
+      governor.budget_ = budget_ms / 1000.0;
+    }
     ImGui::PopItemWidth();
+    ImGui::Text(
+      "Achieved %.1f of %.1f generations/s",
+      game_of_life->simulating_ ? governor.achieved_ : 0.0, governor.rate_);
+    if (game_of_life->engine_.row_ > 0) {
+      const float progress = static_cast<float>(game_of_life->engine_.row_)
+                           / static_cast<float>(game_of_life->board_.height_);
+      const std::string overlay =
+        "Generation " + std::to_string(game_of_life->generation_ + 1);
+      ImGui::ProgressBar(progress, ImVec2(200.0f, 0.0f), overlay.c_str());
+    }
     if (ImGui::Button(game_of_life->simulating_ ? "Pause" : "Play")) {
-      game_of_life->timer_ = 0.0;
+      reset_governor(governor);
       game_of_life->simulating_ = !game_of_life->simulating_;
+      record(
+        game_of_life, game_of_life->simulating_ ? record_event_e::play
+                                                : record_event_e::pause);
     }
     if (game_of_life->simulating_) {
       ImGui::BeginDisabled();
     }
     ImGui::SameLine();
     if (ImGui::Button("Step")) {
-      step_board();
+      record(game_of_life, record_event_e::step);
+      step_board(game_of_life);
     }
     if (game_of_life->simulating_) {
       ImGui::EndDisabled();
     }
     if (ImGui::Button("Clear")) {
-      clear_board(game_of_life->board_);
+      record(game_of_life, record_event_e::clear);
+      clear_bitboard(game_of_life->board_);
+      mark_engine_board(game_of_life->engine_);
+      commit(game_of_life);
       game_of_life->simulating_ = false;
     }
     if (ImGui::Button("Restart")) {
-      clear_board(game_of_life->board_);
+      record(game_of_life, record_event_e::restart);
+      clear_bitboard(game_of_life->board_);
       reset_board(game_of_life->board_);
+      mark_engine_board(game_of_life->engine_);
+      commit(game_of_life);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Randomise")) {
+      randomise(game_of_life);
+      commit(game_of_life);
+    }
+    ImGui::SameLine();
+    ImGui::PushItemWidth(100.0f);
+    const double min_density = 0.0;
+    const double max_density = 1.0;
+    ImGui::SliderScalar(
+      "Density", ImGuiDataType_Double, &game_of_life->soup_.density_,
+      &min_density, &max_density, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+    ImGui::SameLine();
+    ImGui::InputScalar("Seed", ImGuiDataType_U64, &game_of_life->soup_.seed_);
+    ImGui::PopItemWidth();
+    const int64_t head = history_head(game_of_life->history_);
+    int32_t rewind_offset =
+      static_cast<int32_t>(game_of_life->history_.cursor_ - head);
+    ImGui::PushItemWidth(100.0f);
+    if (ImGui::SliderInt(
+          "Rewind", &rewind_offset,
+          static_cast<int32_t>(game_of_life->history_.first_ - head), 0)) {
+      if (game_of_life->simulating_) {
+        game_of_life->simulating_ = false;
+        record(game_of_life, record_event_e::pause);
+      }
+      show_board(
+        game_of_life,
+        seek_history(game_of_life->history_, head + rewind_offset));
+      game_of_life->generation_ =
+        history_generation(game_of_life->history_, head + rewind_offset);
+    }
+    if (game_of_life->timeline_) {
+      timeline_reader_t& timeline = *game_of_life->timeline_;
+      int64_t generation = timeline.generation_;
+      const int64_t first = 0;
+      const int64_t last = timeline.generations_ - 1;
+      if (ImGui::SliderScalar(
+            "Timeline", ImGuiDataType_S64, &generation, &first, &last)) {
+        if (game_of_life->simulating_) {
+          game_of_life->simulating_ = false;
+          record(game_of_life, record_event_e::pause);
+        }
+        show_board(game_of_life, seek_timeline(timeline, generation));
+        game_of_life->generation_ = timeline.generation_;
+        commit(game_of_life);
+      }
     }
+    ImGui::PopItemWidth();
     ImGui::Checkbox("Additive", &game_of_life->additive_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Heat map", &game_of_life->engine_.track_ages_);
+    ImGui::PushItemWidth(150.0f);
+    const std::vector<stamp_t>& stamps = stamp_library();
+    if (ImGui::BeginCombo(
+          "Stamp (R rotates, F flips)",
+          game_of_life->stamp_ < 0
+            ? "None"
+            : stamps[game_of_life->stamp_].name_.c_str())) {
+      if (ImGui::Selectable("None", game_of_life->stamp_ < 0)) {
+        game_of_life->stamp_ = -1;
+      }
+      for (int32_t stamp = 0; stamp < static_cast<int32_t>(stamps.size());
+           stamp++) {
+        if (ImGui::Selectable(
+              stamps[stamp].name_.c_str(), game_of_life->stamp_ == stamp)) {
+          game_of_life->stamp_ = stamp;
+          game_of_life->pasting_ = false;
+        }
+      }
+      ImGui::EndCombo();
+    }
+    const bool selected = game_of_life->selection_.active_;
+    ImGui::BeginDisabled(!selected);
+    if (ImGui::Button("Copy")) {
+      copy_to_clipboard(game_of_life);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Cut")) {
+      copy_to_clipboard(game_of_life);
+      clear_selection(game_of_life);
+      commit(game_of_life);
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (ImGui::Button("Paste")) {
+      begin_paste(game_of_life);
+    }
+    ImGui::BeginDisabled(!selected);
+    ImGui::SameLine();
+    if (ImGui::Button("Rotate")) {
+      transform_selection(game_of_life, 1);
+      commit(game_of_life);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Flip")) {
+      transform_selection(game_of_life, 4);
+      commit(game_of_life);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Erase")) {
+      clear_selection(game_of_life);
+      commit(game_of_life);
+    }
+    ImGui::EndDisabled();
+    if (ImGui::BeginCombo(
+          "Engine", engine_name(game_of_life->engine_.kind_))) {
+      for (int32_t kind = 0; kind < static_cast<int32_t>(engine_e::count);
+           kind++) {
+        const auto engine = static_cast<engine_e>(kind);
+        if (ImGui::Selectable(
+              engine_name(engine), game_of_life->engine_.kind_ == engine,
+              engine_supports(engine, game_of_life->engine_.topology_)
+                ? ImGuiSelectableFlags_None
+                : ImGuiSelectableFlags_Disabled)) {
+          game_of_life->engine_.kind_ = engine;
+          cancel_engine_rows(game_of_life->engine_);
+        }
+      }
+      ImGui::EndCombo();
+    }
+    if (ImGui::BeginCombo(
+          "Topology", topology_name(game_of_life->engine_.topology_))) {
+      for (int32_t kind = 0; kind < static_cast<int32_t>(topology_e::count);
+           kind++) {
+        const auto topology = static_cast<topology_e>(kind);
+        if (ImGui::Selectable(
+              topology_name(topology),
+              game_of_life->engine_.topology_ == topology,
+              engine_supports(game_of_life->engine_.kind_, topology)
+                ? ImGuiSelectableFlags_None
+                : ImGuiSelectableFlags_Disabled)) {
+          game_of_life->engine_.topology_ = topology;
+          cancel_engine_rows(game_of_life->engine_);
+          record(game_of_life, record_event_e::topology);
+        }
+      }
+      ImGui::EndCombo();
+    }
+    if (ImGui::Button("Analyse")) {
+      game_of_life->analyse_.topology_ = game_of_life->engine_.topology_;
+      game_of_life->analysis_ =
+        analyse_board(game_of_life->board_, game_of_life->analyse_);
+    }
+    ImGui::SameLine();
+    ImGui::SliderInt("Gap", &game_of_life->analyse_.gap_, 1, 8);
+    ImGui::PopItemWidth();
+    if (game_of_life->analysis_) {
+      const analyse_result_t& analysis = *game_of_life->analysis_;
+      ImGui::Text(
+        "%lld objects in %.1f ms", static_cast<long long>(analysis.objects_),
+        analysis.seconds_ * 1000.0);
+      if (ImGui::BeginTable(
+            "Objects", 2,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg
+              | ImGuiTableFlags_ScrollY,
+            ImVec2(0.0f, 150.0f))) {
+        ImGui::TableSetupColumn("Object");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableHeadersRow();
+        for (const auto& [name, count] : sorted_counts(analysis)) {
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::TextUnformatted(name.c_str());
+          ImGui::TableNextColumn();
+          ImGui::Text("%lld", static_cast<long long>(count));
+        }
+        ImGui::EndTable();
+      }
+    }
   }
   ImGui::End();
 
-  const auto cell_size = game_of_life->cell_size_;
-  const auto top_left = board_top_left_corner(game_of_life->board_, cell_size);
-  for (int32_t y = 0, height = mc_gol_board_height(game_of_life->board_);
-       y < height; y++) {
-    for (int32_t x = 0, width = mc_gol_board_width(game_of_life->board_);
-         x < width; x++) {
-      const as::vec2 cell_position =
-        top_left + as::vec2(x * cell_size, y * cell_size);
-      const color_t cell_color =
-        mc_gol_board_cell(game_of_life->board_, x, y)
-          ? color_t{.r = 242, .g = 181, .b = 105, .a = 255}
-          : color_t{.r = 84, .g = 122, .b = 171, .a = 255};
-      SDL_SetRenderDrawColor(
-        g_renderer, cell_color.r, cell_color.g, cell_color.b, cell_color.a);
-      const SDL_FRect cell = (SDL_FRect){.x = cell_position.x,
-                                         .y = cell_position.y,
-                                         .w = cell_size,
-                                         .h = cell_size};
-      SDL_RenderFillRect(g_renderer, &cell);
-    }
-  }
-
-  SDL_SetRenderDrawColor(g_renderer, 39, 61, 113, 255);
-  for (int32_t y = 0, height = mc_gol_board_height(game_of_life->board_);
-       y <= height; y++) {
-    SDL_RenderLine(
-      g_renderer, top_left.x, top_left.y + y * cell_size,
-      top_left.x + cell_size * mc_gol_board_width(game_of_life->board_),
-      top_left.y + y * cell_size);
-  }
-  for (int32_t x = 0, width = mc_gol_board_width(game_of_life->board_);
-       x <= width; x++) {
-    SDL_RenderLine(
-      g_renderer, top_left.x + x * cell_size, top_left.y,
-      top_left.x + x * cell_size,
-      top_left.y + cell_size * mc_gol_board_height(game_of_life->board_));
-  }
+  const bitboard_t& board = game_of_life->board_;
+  const layout_t& layout = update_layout(game_of_life);
+  const float cell_size = layout.cell_size_;
+  const as::vec2 top_left = layout.top_left_;
 
+  // dead cells are the board background, live cells are batched in one call
+  const color_t dead_color = {.r = 84, .g = 122, .b = 171, .a = 255};
+  SDL_SetRenderDrawColor(
+    g_renderer, dead_color.r, dead_color.g, dead_color.b, dead_color.a);
+  const SDL_FRect background = {
+    .x = top_left.x,
+    .y = top_left.y,
+    .w = cell_size * board.width_,
+    .h = cell_size * board.height_};
+  SDL_RenderFillRect(g_renderer, &background);
+
+  std::vector<SDL_FRect>& cell_rects = game_of_life->cell_rects_;
+  const color_t alive_color = {.r = 242, .g = 181, .b = 105, .a = 255};
+  const std::vector<uint8_t>& ages = game_of_life->engine_.ages_;
   if (
-    game_of_life->simulating_ && game_of_life->timer_ >= game_of_life->delay_) {
-    step_board();
+    game_of_life->engine_.track_ages_
+    && ages.size() == board.words_.size() * 64) {
+    // newborn cells are pale and redden with age, the dead leave a trail
+    // that fades back into the background
+    const color_t young_color = {.r = 255, .g = 238, .b = 196, .a = 255};
+    const color_t old_color = {.r = 204, .g = 58, .b = 52, .a = 255};
+    const color_t trail_color = {.r = 166, .g = 128, .b = 196, .a = 255};
+    auto& heat_rects = game_of_life->heat_rects_;
+    push_heat_rects(heat_rects, board, ages, layout);
+    for (int32_t level = 0; level < heat_levels * 2; level++) {
+      const color_t color =
+        level < heat_levels
+          ? mix_colors(young_color, old_color, level / (heat_levels - 1.0f))
+          : mix_colors(
+              dead_color, trail_color,
+              (level - heat_levels + 1) / float(heat_levels));
+      SDL_SetRenderDrawColor(g_renderer, color.r, color.g, color.b, color.a);
+      SDL_RenderFillRects(
+        g_renderer, heat_rects[level].data(),
+        static_cast<int>(heat_rects[level].size()));
+    }
+  } else {
+    cell_rects.clear();
+    push_cell_rects(cell_rects, board, {0, 0}, board, layout);
+    SDL_SetRenderDrawColor(
+      g_renderer, alive_color.r, alive_color.g, alive_color.b, alive_color.a);
+    SDL_RenderFillRects(
+      g_renderer, cell_rects.data(), static_cast<int>(cell_rects.size()));
+  }
+
+  // ghost of the stamp or paste following the cursor
+  const bitboard_t* floating = floating_pattern(game_of_life);
+  if (floating != nullptr && on_board(board, game_of_life->hover_)) {
+    cell_rects.clear();
+    push_cell_rects(
+      cell_rects, *floating, floating_corner(game_of_life, *floating), board,
+      layout);
+    SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(
+      g_renderer, alive_color.r, alive_color.g, alive_color.b, 128);
+    SDL_RenderFillRects(
+      g_renderer, cell_rects.data(), static_cast<int>(cell_rects.size()));
+    SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_NONE);
+  }
+
+  if (game_of_life->selection_.active_) {
+    const region_t& region = game_of_life->selection_.region_;
+    const SDL_FRect outline = {
+      .x = top_left.x + region.min_.x * cell_size,
+      .y = top_left.y + region.min_.y * cell_size,
+      .w = (region.max_.x - region.min_.x) * cell_size,
+      .h = (region.max_.y - region.min_.y) * cell_size};
+    SDL_SetRenderDrawColor(g_renderer, 255, 255, 255, 255);
+    SDL_RenderRect(g_renderer, &outline);
+  }
+
+  if (layout.grid_alpha_ > 0) {
+    SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(g_renderer, 39, 61, 113, layout.grid_alpha_);
+    SDL_RenderLines(
+      g_renderer, layout.grid_points_.data(),
+      static_cast<int>(layout.grid_points_.size()));
+    SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_NONE);
+  }
+
+  if (game_of_life->simulating_ || game_of_life->control_steps_ > 0) {
+    // generations are stepped a slice of rows at a time until the frame's
+    // budget runs out, so a board too big to step in a frame still lets the
+    // window redraw (one left part way through is finished next frame). the
+    // history and publisher commit after each generation comes out of the
+    // same budget. a step command's generations go first and as many as fit
+    // are stepped
+    const bool simulating = game_of_life->simulating_;
+    const int32_t owed =
+      simulating ? advance_governor(game_of_life->governor_, delta_time) : 0;
+    const auto steps = static_cast<int32_t>(std::min<int64_t>(
+      game_of_life->control_steps_ + owed,
+      std::numeric_limits<int32_t>::max()));
+    const uint64_t deadline =
+      SDL_GetTicksNS()
+      + static_cast<uint64_t>(game_of_life->governor_.budget_ * 1e9);
+    const int32_t slice_rows =
+      std::max(slice_words / game_of_life->board_.stride_, 2);
+    int32_t stepped = 0;
+    int32_t commanded = 0; // of stepped, for a step command
+    bool sliced = false; // a slice every frame, however slow a commit is
+    while ((stepped < steps || game_of_life->engine_.row_ > 0)
+           && (!sliced
+               || SDL_GetTicksNS() + game_of_life->commit_ns_ < deadline)) {
+      sliced = true;
+      if (step_engine_rows(
+            game_of_life->engine_, game_of_life->board_, slice_rows)) {
+        game_of_life->generation_++;
+        game_of_life->stepped_++;
+        const uint64_t commit_ns = SDL_GetTicksNS();
+        commit(game_of_life);
+        game_of_life->commit_ns_ = SDL_GetTicksNS() - commit_ns;
+        stepped++;
+        if (game_of_life->control_steps_ > 0) {
+          game_of_life->control_steps_--;
+          commanded++;
+        }
+      }
+    }
+    if (simulating) {
+      settle_governor(game_of_life->governor_, owed, stepped - commanded);
+      measure_governor(game_of_life->governor_, delta_time, stepped);
+    }
   }
 
   SDL_SetRenderDrawColor(g_renderer, 255, 255, 255, 255);
@@ -278,6 +1986,11 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event) {
   auto* game_of_life = static_cast<game_of_life_t*>(appstate);
   if (event->type == SDL_EVENT_MOUSE_MOTION) {
     SDL_MouseMotionEvent* mouse_motion = (SDL_MouseMotionEvent*)event;
+    game_of_life->hover_ =
+      cell_at(game_of_life, as::vec2(mouse_motion->x, mouse_motion->y));
+    if (game_of_life->selection_.dragging_) {
+      update_selection(game_of_life);
+    }
     if (game_of_life->pressing_) {
       toggle_cell(game_of_life, as::vec2(mouse_motion->x, mouse_motion->y));
     }
@@ -285,21 +1998,105 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event) {
 
   if (event->type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
     SDL_MouseButtonEvent* mouse_button = (SDL_MouseButtonEvent*)event;
-    if (mouse_button->button == SDL_BUTTON_LEFT) {
+    const bool editing = floating_pattern(game_of_life) != nullptr
+                      || (SDL_GetModState() & SDL_KMOD_SHIFT) != 0;
+    if (
+      mouse_button->button == SDL_BUTTON_LEFT && editing
+      && !ImGui::GetIO().WantCaptureMouse) {
+      game_of_life->hover_ =
+        cell_at(game_of_life, as::vec2(mouse_button->x, mouse_button->y));
+      if (floating_pattern(game_of_life) != nullptr) {
+        if (on_board(game_of_life->board_, game_of_life->hover_)) {
+          place_floating(game_of_life);
+          commit(game_of_life);
+        }
+      } else {
+        // shift drag selects
+        game_of_life->selection_.anchor_ = game_of_life->hover_;
+        game_of_life->selection_.dragging_ = true;
+        update_selection(game_of_life);
+      }
+    } else if (mouse_button->button == SDL_BUTTON_LEFT) {
       game_of_life->pressing_ = true;
       toggle_cell(game_of_life, as::vec2(mouse_button->x, mouse_button->y));
     }
   }
 
+  if (
+    event->type == SDL_EVENT_KEY_DOWN && !ImGui::GetIO().WantCaptureKeyboard) {
+    const bool command = (event->key.mod & (SDL_KMOD_CTRL | SDL_KMOD_GUI)) != 0;
+    const bool selected = game_of_life->selection_.active_;
+    switch (event->key.key) {
+      case SDLK_R:
+        rotate_edit(game_of_life);
+        break;
+      case SDLK_F:
+        flip_edit(game_of_life);
+        break;
+      case SDLK_C:
+        if (command && selected) {
+          copy_to_clipboard(game_of_life);
+        }
+        break;
+      case SDLK_X:
+        if (command && selected) {
+          copy_to_clipboard(game_of_life);
+          clear_selection(game_of_life);
+          commit(game_of_life);
+        }
+        break;
+      case SDLK_V:
+        if (command) {
+          begin_paste(game_of_life);
+        }
+        break;
+      case SDLK_DELETE:
+      case SDLK_BACKSPACE:
+        if (selected) {
+          clear_selection(game_of_life);
+          commit(game_of_life);
+        }
+        break;
+      case SDLK_ESCAPE:
+        game_of_life->stamp_ = -1;
+        game_of_life->pasting_ = false;
+        game_of_life->selection_.active_ = false;
+        break;
+      default:
+        break;
+    }
+  }
+
   if (event->type == SDL_EVENT_MOUSE_BUTTON_UP) {
     SDL_MouseButtonEvent* mouse_button = (SDL_MouseButtonEvent*)event;
-    if (mouse_button->button == SDL_BUTTON_LEFT) {
+    if (mouse_button->button == SDL_BUTTON_LEFT && game_of_life->pressing_) {
       game_of_life->pressing_ = false;
+      commit(game_of_life);
+    }
+    if (mouse_button->button == SDL_BUTTON_LEFT) {
+      game_of_life->selection_.dragging_ = false;
     }
   }
 
-  if (event->type == SDL_EVENT_WINDOW_FOCUS_LOST) {
+  if (
+    event->type == SDL_EVENT_MOUSE_WHEEL && !ImGui::GetIO().WantCaptureMouse) {
+    SDL_MouseWheelEvent* mouse_wheel = (SDL_MouseWheelEvent*)event;
+    game_of_life->cell_size_ = std::clamp(
+      game_of_life->cell_size_ * SDL_powf(1.1f, mouse_wheel->y), min_cell_size,
+      max_cell_size);
+    game_of_life->layout_.dirty_ = true;
+  }
+
+  if (
+    event->type == SDL_EVENT_WINDOW_RESIZED
+    || event->type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED
+    || event->type == SDL_EVENT_WINDOW_DISPLAY_SCALE_CHANGED) {
+    game_of_life->layout_.dirty_ = true;
+  }
+
+  if (event->type == SDL_EVENT_WINDOW_FOCUS_LOST && game_of_life->pressing_) {
     game_of_life->pressing_ = false;
+    commit(game_of_life);
   }
 
   if (event->type == SDL_EVENT_QUIT) {
@@ -311,7 +2108,17 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event) {
 
 void SDL_AppQuit(void* appstate, SDL_AppResult result) {
   const auto game_of_life = static_cast<game_of_life_t*>(appstate);
-  mc_gol_destroy_board(game_of_life->board_);
+  if (game_of_life == nullptr) {
+    return; // headless run or failed startup
+  }
+  end_recording(
+    game_of_life->recorder_, game_of_life->stepped_,
+    bitboard_hash(game_of_life->board_));
+  destroy_engine(game_of_life->engine_);
+  close_publisher(game_of_life->publisher_);
+  if (game_of_life->control_ != nullptr) {
+    close_control(*game_of_life->control_);
+  }
   delete game_of_life;
 
   ImGui_ImplSDLRenderer3_Shutdown();
@@ -0,0 +1,235 @@
+#include "pattern.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <string>
+#include <utility>
+
+namespace {
+
+  struct run_t {
+    int32_t x;
+    int32_t y;
+    int32_t length;
+  };
+
+  // reads the number following name = in an rle header line, -1 if missing
+  // (saturating at INT32_MAX)
+  int32_t header_value(std::string_view line, const char name) {
+    for (size_t i = 0; i < line.size(); i++) {
+      if (line[i] != name || (i > 0 && std::isalpha(line[i - 1]))) {
+        continue;
+      }
+      size_t at = i + 1;
+      while (at < line.size() && line[at] == ' ') {
+        at++;
+      }
+      if (at == line.size() || line[at] != '=') {
+        continue;
+      }
+      at++;
+      while (at < line.size() && line[at] == ' ') {
+        at++;
+      }
+      int64_t value = 0;
+      bool digits = false;
+      for (; at < line.size() && std::isdigit(line[at]); at++) {
+        value = std::min<int64_t>(value * 10 + (line[at] - '0'), INT32_MAX);
+        digits = true;
+      }
+      return digits ? int32_t(value) : -1;
+    }
+    return -1;
+  }
+
+  void set_cells(bitboard_t& board, const run_t& run) {
+    for (int32_t x = run.x; x < run.x + run.length; x++) {
+      set_bitboard_cell(board, x, run.y, true);
+    }
+  }
+
+  const char* const g_library[][2] = {
+    {"Glider", "bo$2bo$3o!"},
+    {"Lightweight spaceship", "bo2bo$o4b$o3bo$4o!"},
+    {"Middleweight spaceship", "3bo2b$bo3bo$o5b$o4bo$5o!"},
+    {"Heavyweight spaceship", "3b2o2b$bo4bo$o6b$o5bo$6o!"},
+    {"Gosper glider gun",
+     "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4b"
+     "obo$10bo5bo7bo$11bo3bo$12b2o!"},
+    {"Simkin glider gun",
+     "2o5b2o$2o5b2o2$4b2o$4b2o5$22b2ob2o$21bo5bo$21bo6bo2b2o$21b3o3bo3b2o$"
+     "26bo4$20b2o$20bo$21b3o$23bo!"},
+    {"Eater 1", "2o2b$obo$2bo$2b2o!"},
+    {"Puffer train", "3bo$4bo$o3bo$b4o4$o$b2o$2bo$2bo$bo3$3bo$4bo$o3bo$b4o!"},
+    {"Block", "2o$2o!"},
+    {"Beehive", "b2o$o2bo$b2o!"},
+    {"Blinker", "3o!"},
+    {"Pulsar",
+     "2b3o3b3o2$o4bobo4bo$o4bobo4bo$o4bobo4bo$2b3o3b3o2$2b3o3b3o$o4bobo4bo$"
+     "o4bobo4bo$o4bobo4bo2$2b3o3b3o!"},
+    {"Pentadecathlon", "2bo4bo$2ob4ob2o$2bo4bo!"},
+    {"R-pentomino", "b2o$2o$bo!"},
+    {"Acorn", "bo$3bo$2o2b3o!"},
+    {"Diehard", "6bo$2o$bo3b3o!"},
+  };
+
+} // namespace
+
+bool parse_rle(
+  std::string_view rle, bitboard_t& pattern, const int32_t max_width,
+  const int32_t max_height) {
+  int32_t width = -1;
+  int32_t height = -1;
+  std::vector<run_t> runs;
+  // positions and counts are kept within the largest pattern accepted, so
+  // none of them can overflow
+  const int64_t max_count = std::max(max_width, max_height) + int64_t(1);
+  int64_t x = 0;
+  int64_t y = 0;
+  int64_t extent_x = 0;
+  int64_t count = 0;
+  bool ended = false;
+  while (!rle.empty() && !ended) {
+    const size_t line_end = std::min(rle.find('\n'), rle.size());
+    std::string_view line = rle.substr(0, line_end);
+    rle.remove_prefix(std::min(line_end + 1, rle.size()));
+    const size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos || line[first] == '#') {
+      continue;
+    }
+    if (line[first] == 'x' && line.find('=') != std::string_view::npos) {
+      width = header_value(line, 'x');
+      height = header_value(line, 'y');
+      if (width > max_width || height > max_height) {
+        return false;
+      }
+      continue;
+    }
+    for (const char c : line) {
+      if (std::isdigit(c)) {
+        count = std::min(count * 10 + (c - '0'), max_count);
+        continue;
+      }
+      if (c == ' ' || c == '\t' || c == '\r') {
+        continue;
+      }
+      const int64_t length = count == 0 ? 1 : count;
+      count = 0;
+      if (c == '!') {
+        ended = true;
+        break;
+      }
+      if (c == '$') {
+        y += length;
+        x = 0;
+      } else if (c == 'b' || c == '.') {
+        x += length;
+      } else if (std::isalpha(c)) {
+        if (x + length > max_width || y >= max_height) {
+          return false;
+        }
+        runs.push_back({int32_t(x), int32_t(y), int32_t(length)});
+        x += length;
+      } else {
+        return false;
+      }
+      if (x > max_width || y > max_height) {
+        return false;
+      }
+      extent_x = std::max(extent_x, x);
+    }
+  }
+  const int32_t extent_y =
+    runs.empty() ? 0 : runs.back().y + 1; // runs are in row order
+  if (width < 0 || height < 0) {
+    width = int32_t(extent_x);
+    height = extent_y;
+  }
+  if (width <= 0 || height <= 0 || extent_x > width || extent_y > height) {
+    return false;
+  }
+  pattern = make_bitboard(width, height);
+  for (const run_t& run : runs) {
+    set_cells(pattern, run);
+  }
+  return true;
+}
+
+std::string write_rle(const bitboard_t& pattern) {
+  std::string rle = "x = " + std::to_string(pattern.width_)
+                  + ", y = " + std::to_string(pattern.height_)
+                  + ", rule = B3/S23\n";
+  size_t line_start = rle.size();
+  const auto emit = [&rle, &line_start](const int32_t count, const char tag) {
+    std::string run = count > 1 ? std::to_string(count) : std::string();
+    run += tag;
+    if (rle.size() - line_start + run.size() > 70) {
+      rle += '\n';
+      line_start = rle.size();
+    }
+    rle += run;
+  };
+  int32_t pending_rows = 0; // row ends not yet written
+  for (int32_t y = 0; y < pattern.height_; y++) {
+    int32_t x = 0;
+    while (x < pattern.width_) {
+      const bool alive = bitboard_cell(pattern, x, y);
+      int32_t end = x + 1;
+      while (end < pattern.width_ && bitboard_cell(pattern, end, y) == alive) {
+        end++;
+      }
+      if (alive || end < pattern.width_) { // trailing dead cells are implied
+        if (pending_rows > 0) {
+          emit(pending_rows, '$');
+          pending_rows = 0;
+        }
+        emit(end - x, alive ? 'o' : 'b');
+      }
+      x = end;
+    }
+    pending_rows++;
+  }
+  rle += "!\n";
+  return rle;
+}
+
+bitboard_t orient_bitboard(
+  const bitboard_t& pattern, const int32_t orientation) {
+  const bitboard_t mirrored =
+    (orientation & 4) != 0 ? mirror_bitboard(pattern) : pattern;
+  switch (orientation & 3) {
+    case 1: // clockwise, (x, y) -> (height - 1 - y, x)
+      return mirror_bitboard(transpose_bitboard(mirrored));
+    case 2:
+      return flip_bitboard(mirror_bitboard(mirrored));
+    case 3: // anticlockwise, (x, y) -> (y, width - 1 - x)
+      return flip_bitboard(transpose_bitboard(mirrored));
+    default:
+      return mirrored;
+  }
+}
+
+stamp_t make_stamp(std::string name, const bitboard_t& pattern) {
+  stamp_t stamp;
+  stamp.name_ = std::move(name);
+  for (int32_t orientation = 0; orientation < orientation_count;
+       orientation++) {
+    stamp.orientations_[orientation] = orient_bitboard(pattern, orientation);
+  }
+  return stamp;
+}
+
+const std::vector<stamp_t>& stamp_library() {
+  static const std::vector<stamp_t> library = [] {
+    std::vector<stamp_t> stamps;
+    for (const auto& [name, rle] : g_library) {
+      bitboard_t pattern;
+      if (parse_rle(rle, pattern)) {
+        stamps.push_back(make_stamp(name, pattern));
+      }
+    }
+    return stamps;
+  }();
+  return library;
+}
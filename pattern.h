@@ -0,0 +1,46 @@
+#pragma once
+
+#include "bitboard.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// cells a side of a pattern read without a board it has to fit on
+constexpr int32_t max_rle_extent = 1 << 16;
+
+// reads a pattern in run length encoded format (the "x = , y =" header line
+// and # comment lines are optional), false if it's malformed or bigger than
+// max_width by max_height (checked before anything is allocated)
+bool parse_rle(
+  std::string_view rle, bitboard_t& pattern,
+  int32_t max_width = max_rle_extent, int32_t max_height = max_rle_extent);
+std::string write_rle(const bitboard_t& pattern);
+
+// orientation 0-3 rotates clockwise by 90 degrees that many times, 4-7 do the
+// same after mirroring left to right
+constexpr int32_t orientation_count = 8;
+
+// built from word transforms (transpose, mirror and flip)
+bitboard_t orient_bitboard(const bitboard_t& pattern, int32_t orientation);
+
+inline int32_t rotate_orientation(const int32_t orientation) {
+  return (orientation & 4) | ((orientation + 1) & 3);
+}
+
+inline int32_t flip_orientation(const int32_t orientation) {
+  return orientation ^ 4;
+}
+
+// a pattern rasterised in every orientation up front, ready to blit
+struct stamp_t {
+  std::string name_;
+  std::array<bitboard_t, orientation_count> orientations_;
+};
+
+stamp_t make_stamp(std::string name, const bitboard_t& pattern);
+
+// common still lifes, oscillators, spaceships, guns, eaters and puffers
+const std::vector<stamp_t>& stamp_library();
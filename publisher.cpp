@@ -0,0 +1,153 @@
+#include "publisher.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if !defined(_WIN32)
+
+namespace {
+
+  shared_board_header_t* header(publisher_t& publisher) {
+    return static_cast<shared_board_header_t*>(publisher.memory_);
+  }
+
+  shared_board_slot_t* slot(publisher_t& publisher, const uint32_t index) {
+    return reinterpret_cast<shared_board_slot_t*>(
+      static_cast<uint8_t*>(publisher.memory_)
+      + shared_board_slot_offset(*header(publisher), index));
+  }
+
+  // a segment with another layout (or none yet) or whose publisher has exited
+  // without unlinking it, false for one that may still be in use
+  bool stale_segment(const char* name) {
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat status = {};
+    void* memory = MAP_FAILED;
+    if (
+      fstat(fd, &status) == 0
+      && size_t(status.st_size) >= sizeof(shared_board_header_t)) {
+      memory = mmap(
+        nullptr, sizeof(shared_board_header_t), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (memory == MAP_FAILED) {
+      return false;
+    }
+    const auto* shared = static_cast<const shared_board_header_t*>(memory);
+    const bool stale =
+      shared->magic_ != shared_board_magic
+      || (shared->version_ == shared_board_version && shared->pid_ > 0
+          && kill(shared->pid_, 0) != 0 && errno == ESRCH);
+    munmap(memory, sizeof(shared_board_header_t));
+    return stale;
+  }
+
+} // namespace
+
+bool open_publisher(
+  publisher_t& publisher, const char* name, const bitboard_t& board) {
+  close_publisher(publisher);
+  const size_t slot_size =
+    (sizeof(shared_board_slot_t) + board.words_.size() * sizeof(uint64_t)
+     + 63)
+    & ~size_t(63);
+  const size_t size = sizeof(shared_board_header_t) + slot_size * 2;
+
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0 && errno == EEXIST && stale_segment(name)) {
+    shm_unlink(name); // left behind by a crash
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  }
+  if (fd < 0) {
+    return false;
+  }
+  void* memory = MAP_FAILED;
+  if (ftruncate(fd, off_t(size)) == 0) {
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd); // the mapping keeps the segment open
+  if (memory == MAP_FAILED) {
+    shm_unlink(name);
+    return false;
+  }
+  publisher.name_ = name;
+  publisher.memory_ = memory;
+  publisher.size_ = size;
+
+  // the segment starts zeroed, so both slots are at sequence 0 (readable,
+  // generation 0 of an empty board) until the first publish
+  new (memory) shared_board_header_t{
+    .magic_ = shared_board_magic,
+    .version_ = shared_board_version,
+    .width_ = board.width_,
+    .height_ = board.height_,
+    .stride_ = board.stride_,
+    .slot_size_ = uint32_t(slot_size),
+    .latest_ = 0,
+    .pid_ = int32_t(getpid())};
+  for (uint32_t index = 0; index < 2; index++) {
+    new (slot(publisher, index)) shared_board_slot_t{};
+  }
+  return true;
+}
+
+void publish_board(
+  publisher_t& publisher, const bitboard_t& board, const int64_t generation,
+  const double rate, const uint64_t published_ns) {
+  if (publisher.memory_ == nullptr) {
+    return;
+  }
+  shared_board_header_t* shared = header(publisher);
+  if (shared->width_ != board.width_ || shared->height_ != board.height_) {
+    return;
+  }
+  const uint32_t index = 1 - shared->latest_.load(std::memory_order_relaxed);
+  shared_board_slot_t* next = slot(publisher, index);
+  const uint64_t sequence = next->sequence_.load(std::memory_order_relaxed);
+  next->sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  next->generation_ = generation;
+  next->population_ = bitboard_population(board);
+  next->rate_ = rate;
+  next->published_ns_ = published_ns;
+  std::memcpy(
+    shared_board_words(next), board.words_.data(),
+    board.words_.size() * sizeof(uint64_t));
+  next->sequence_.store(sequence + 2, std::memory_order_release);
+  shared->latest_.store(index, std::memory_order_release);
+}
+
+void close_publisher(publisher_t& publisher) {
+  if (publisher.memory_ == nullptr) {
+    return;
+  }
+  munmap(publisher.memory_, publisher.size_);
+  shm_unlink(publisher.name_.c_str());
+  publisher = publisher_t{};
+}
+
+#else
+
+bool open_publisher(publisher_t&, const char*, const bitboard_t&) {
+  return false; // no POSIX shared memory
+}
+
+void publish_board(publisher_t&, const bitboard_t&, int64_t, double, uint64_t) {
+}
+
+void close_publisher(publisher_t&) {
+}
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "bitboard.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// the live board published to a POSIX shared memory segment (not available on
+// Windows) so other local processes can map it and read it in place
+//
+// layout: a shared_board_header_t then two slots, each a shared_board_slot_t
+// followed by the board's words (stride_ words a row, as bitboard_t), at
+// offsets shared_board_slot_offset(header, 0 and 1)
+//
+// every generation is written to the slot readers aren't pointed at, which is
+// then made latest_, so readers almost never wait on the writer. a slot's
+// sequence_ is odd while it's being written; to read, load latest_, load the
+// slot's sequence_ (retry if it's odd), read the slot then check sequence_
+// hasn't changed
+
+constexpr uint32_t shared_board_magic = 0x4c4f4753; // "SGOL"
+constexpr uint32_t shared_board_version = 2;
+
+// both structs start on their own cache line
+struct alignas(64) shared_board_header_t {
+  uint32_t magic_;
+  uint32_t version_;
+  int32_t width_;
+  int32_t height_;
+  int32_t stride_;
+  uint32_t slot_size_; // bytes, the slot, its words and padding to 64 bytes
+  std::atomic<uint32_t> latest_; // slot holding the newest generation
+  int32_t pid_; // of the publisher, a segment it outlived can be replaced
+};
+
+struct alignas(64) shared_board_slot_t {
+  std::atomic<uint64_t> sequence_;
+  int64_t generation_;
+  int64_t population_;
+  double rate_; // achieved generations/s
+  uint64_t published_ns_; // SDL_GetTicksNS when the slot was written
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+inline size_t shared_board_slot_offset(
+  const shared_board_header_t& header, uint32_t slot) {
+  return sizeof(shared_board_header_t) + size_t(slot) * header.slot_size_;
+}
+
+inline const uint64_t* shared_board_words(const shared_board_slot_t* slot) {
+  return reinterpret_cast<const uint64_t*>(slot + 1);
+}
+
+inline uint64_t* shared_board_words(shared_board_slot_t* slot) {
+  return reinterpret_cast<uint64_t*>(slot + 1);
+}
+
+struct publisher_t {
+  std::string name_;
+  void* memory_ = nullptr;
+  size_t size_ = 0;
+};
+
+// creates the segment named name ("/game-of-life" for example) sized for
+// board, only replacing one that's stale (not this layout, or left by a
+// publisher that has exited) so a running instance is never taken over
+bool open_publisher(
+  publisher_t& publisher, const char* name, const bitboard_t& board);
+// copies board into the free slot and makes it the latest, does nothing if no
+// segment is open or board isn't the size it was opened for
+void publish_board(
+  publisher_t& publisher, const bitboard_t& board, int64_t generation,
+  double rate, uint64_t published_ns);
+// unmaps and unlinks the segment
+void close_publisher(publisher_t& publisher);
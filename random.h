@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+// small fast seeded generators (splitmix64 for seeding, xoshiro256** for bulk)
+
+inline uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+struct xoshiro256_t {
+  uint64_t s_[4];
+};
+
+inline xoshiro256_t make_xoshiro256(uint64_t seed) {
+  xoshiro256_t rng;
+  for (uint64_t& s : rng.s_) {
+    s = splitmix64(seed);
+  }
+  return rng;
+}
+
+inline uint64_t xoshiro256_next(xoshiro256_t& rng) {
+  uint64_t* s = rng.s_;
+  const uint64_t x = s[1] * 5;
+  const uint64_t result = ((x << 7) | (x >> 57)) * 9;
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 45) | (s[3] >> 19);
+  return result;
+}
+
+// uniform double in [0, 1)
+inline double xoshiro256_unit(xoshiro256_t& rng) {
+  return static_cast<double>(xoshiro256_next(rng) >> 11) * 0x1.0p-53;
+}
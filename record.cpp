@@ -0,0 +1,215 @@
+#include "record.h"
+
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+  constexpr char g_magic[4] = {'G', 'O', 'L', 'R'};
+  constexpr uint8_t g_version = 2;
+
+  void write_varint(std::ofstream& file, uint64_t value) {
+    char bytes[10];
+    int32_t count = 0;
+    do {
+      bytes[count++] = char((value & 0x7f) | (value >= 0x80 ? 0x80 : 0));
+      value >>= 7;
+    } while (value != 0);
+    file.write(bytes, count);
+  }
+
+  template<typename T>
+  void write_fixed(std::ofstream& file, const T value) {
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); i++) {
+      bytes[i] = char(value >> (i * 8));
+    }
+    file.write(bytes, sizeof(T));
+  }
+
+  struct reader_t {
+    const uint8_t* data_;
+    const uint8_t* end_;
+    bool failed_ = false;
+
+    uint8_t u8() {
+      if (data_ == end_) {
+        failed_ = true;
+        return 0;
+      }
+      return *data_++;
+    }
+
+    uint64_t varint() {
+      uint64_t value = 0;
+      for (int32_t shift = 0; shift < 64; shift += 7) {
+        const uint8_t byte = u8();
+        value |= uint64_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+          return value;
+        }
+      }
+      failed_ = true;
+      return 0;
+    }
+
+    template<typename T>
+    T fixed() {
+      T value = 0;
+      for (size_t i = 0; i < sizeof(T); i++) {
+        value |= T(u8()) << (i * 8);
+      }
+      return value;
+    }
+  };
+
+} // namespace
+
+bool begin_recording(
+  recorder_t& recorder, const char* path, const bitboard_t& initial) {
+  recorder.file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!recorder.file_) {
+    return false;
+  }
+  recorder.generation_ = 0;
+  recorder.file_.write(g_magic, sizeof(g_magic));
+  recorder.file_.put(char(g_version));
+  write_varint(recorder.file_, uint64_t(initial.width_));
+  write_varint(recorder.file_, uint64_t(initial.height_));
+  for (const uint64_t word : initial.words_) {
+    write_fixed(recorder.file_, word);
+  }
+  return bool(recorder.file_);
+}
+
+void record_event(recorder_t& recorder, const record_event_t& event) {
+  if (!recording(recorder)) {
+    return;
+  }
+  recorder.file_.put(char(event.type_));
+  write_varint(
+    recorder.file_, uint64_t(event.generation_ - recorder.generation_));
+  recorder.generation_ = event.generation_;
+  switch (event.type_) {
+    case record_event_e::cell_on:
+    case record_event_e::cell_off:
+      write_varint(recorder.file_, uint64_t(event.x_));
+      write_varint(recorder.file_, uint64_t(event.y_));
+      break;
+    case record_event_e::rate:
+      write_fixed(recorder.file_, std::bit_cast<uint32_t>(event.rate_));
+      break;
+    case record_event_e::topology:
+      recorder.file_.put(char(event.topology_));
+      break;
+    case record_event_e::end:
+      write_fixed(recorder.file_, event.hash_);
+      break;
+    default:
+      break;
+  }
+}
+
+void end_recording(
+  recorder_t& recorder, const int64_t generation, const uint64_t hash) {
+  if (!recording(recorder)) {
+    return;
+  }
+  record_event(
+    recorder, record_event_t{
+                .type_ = record_event_e::end,
+                .generation_ = generation,
+                .hash_ = hash});
+  recorder.file_.close();
+}
+
+bool load_recording(const char* path, recording_t& recording) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  const std::vector<uint8_t> bytes(
+    (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (
+    bytes.size() < sizeof(g_magic) + 1
+    || std::memcmp(bytes.data(), g_magic, sizeof(g_magic)) != 0
+    || bytes[sizeof(g_magic)] == 0 || bytes[sizeof(g_magic)] > g_version) {
+    return false;
+  }
+  const uint8_t version = bytes[sizeof(g_magic)];
+
+  reader_t reader{
+    .data_ = bytes.data() + sizeof(g_magic) + 1,
+    .end_ = bytes.data() + bytes.size()};
+  const uint64_t width_value = reader.varint();
+  const uint64_t height_value = reader.varint();
+  // the initial board's words have to fit in what's left of the file
+  const auto remaining = uint64_t(reader.end_ - reader.data_);
+  if (
+    reader.failed_ || width_value == 0 || height_value == 0
+    || width_value > INT32_MAX || height_value > INT32_MAX
+    || (width_value + 63) / 64 > remaining / sizeof(uint64_t) / height_value) {
+    return false;
+  }
+  const auto width = int32_t(width_value);
+  const auto height = int32_t(height_value);
+  recording.initial_ = make_bitboard(width, height);
+  for (uint64_t& word : recording.initial_.words_) {
+    word = reader.fixed<uint64_t>();
+  }
+
+  recording.events_.clear();
+  int64_t generation = 0;
+  while (!reader.failed_) {
+    record_event_t event{.type_ = record_event_e(reader.u8())};
+    generation += int64_t(reader.varint());
+    event.generation_ = generation;
+    switch (event.type_) {
+      case record_event_e::cell_on:
+      case record_event_e::cell_off: {
+        // checked before narrowing so a huge varint can't wrap onto the board
+        const uint64_t x = reader.varint();
+        const uint64_t y = reader.varint();
+        if (x >= uint64_t(width) || y >= uint64_t(height)) {
+          return false;
+        }
+        event.x_ = int32_t(x);
+        event.y_ = int32_t(y);
+        break;
+      }
+      case record_event_e::rate:
+        event.rate_ = std::bit_cast<float>(reader.fixed<uint32_t>());
+        if (version == 1) {
+          event.rate_ = event.rate_ > 0.0f ? 1.0f / event.rate_ : 0.0f;
+        }
+        break;
+      case record_event_e::topology:
+        event.topology_ = topology_e(reader.u8());
+        if (event.topology_ >= topology_e::count) {
+          return false;
+        }
+        break;
+      case record_event_e::end:
+        event.hash_ = reader.fixed<uint64_t>();
+        break;
+      case record_event_e::clear:
+      case record_event_e::restart:
+      case record_event_e::step:
+      case record_event_e::play:
+      case record_event_e::pause:
+        break;
+      default:
+        return false;
+    }
+    if (reader.failed_) {
+      return false;
+    }
+    recording.events_.push_back(event);
+    if (event.type_ == record_event_e::end) {
+      return true;
+    }
+  }
+  return false;
+}
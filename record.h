@@ -0,0 +1,56 @@
+#pragma once
+
+#include "bitboard.h"
+#include "topology.h"
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+// everything that can change the board during an interactive session
+enum class record_event_e : uint8_t {
+  cell_on,
+  cell_off,
+  clear,
+  restart,
+  step,
+  play,
+  pause,
+  rate, // delay (seconds per generation) in version 1 logs
+  end,
+  topology // appended so older logs stay readable
+};
+
+struct record_event_t {
+  record_event_e type_;
+  int64_t generation_ = 0; // generation the event happened on
+  int32_t x_ = 0; // cell_on/cell_off
+  int32_t y_ = 0;
+  float rate_ = 0.0f; // rate (generations per second)
+  topology_e topology_ = topology_e::torus; // topology
+  uint64_t hash_ = 0; // end (final board hash)
+};
+
+// streams a session to a compact binary log
+// layout: "GOLR", version, width, height, initial board words, then events as
+// type byte, generation delta (varint) and an optional payload
+struct recorder_t {
+  std::ofstream file_;
+  int64_t generation_ = 0;
+};
+
+bool begin_recording(
+  recorder_t& recorder, const char* path, const bitboard_t& initial);
+void record_event(recorder_t& recorder, const record_event_t& event);
+void end_recording(recorder_t& recorder, int64_t generation, uint64_t hash);
+
+inline bool recording(const recorder_t& recorder) {
+  return recorder.file_.is_open();
+}
+
+struct recording_t {
+  bitboard_t initial_;
+  std::vector<record_event_t> events_; // always terminated by an end event
+};
+
+bool load_recording(const char* path, recording_t& recording);
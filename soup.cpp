@@ -0,0 +1,204 @@
+#include "soup.h"
+#include "random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+  constexpr int32_t g_lanes = 4; // generators stepped together
+  constexpr int32_t g_density_bits = 16;
+  // words filled per task, each seeded by its index so the cells don't
+  // depend on which thread fills them
+  constexpr int64_t g_chunk_words = 1 << 16;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  constexpr int32_t g_vectors = g_lanes / 2;
+
+  // g_lanes xoshiro256** generators with their state words side by side, two
+  // to a register (the multiplies are shifts and adds)
+  struct lanes_t {
+    __m128i s_[4][g_vectors];
+  };
+
+  lanes_t make_lanes(uint64_t seed) {
+    uint64_t s[4][g_lanes];
+    for (int32_t lane = 0; lane < g_lanes; lane++) {
+      for (int32_t i = 0; i < 4; i++) {
+        s[i][lane] = splitmix64(seed);
+      }
+    }
+    lanes_t rng;
+    for (int32_t i = 0; i < 4; i++) {
+      for (int32_t vector = 0; vector < g_vectors; vector++) {
+        rng.s_[i][vector] = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(s[i] + vector * 2));
+      }
+    }
+    return rng;
+  }
+
+  inline __m128i rotate_left(const __m128i x, const int32_t k) {
+    return _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - k));
+  }
+
+  inline void next_lanes(lanes_t& rng, __m128i (&words)[g_vectors]) {
+    __m128i(&s)[4][g_vectors] = rng.s_;
+    for (int32_t vector = 0; vector < g_vectors; vector++) {
+      const __m128i x =
+        _mm_add_epi64(s[1][vector], _mm_slli_epi64(s[1][vector], 2));
+      const __m128i r = rotate_left(x, 7);
+      words[vector] = _mm_add_epi64(r, _mm_slli_epi64(r, 3));
+      const __m128i t = _mm_slli_epi64(s[1][vector], 17);
+      s[2][vector] = _mm_xor_si128(s[2][vector], s[0][vector]);
+      s[3][vector] = _mm_xor_si128(s[3][vector], s[1][vector]);
+      s[1][vector] = _mm_xor_si128(s[1][vector], s[2][vector]);
+      s[0][vector] = _mm_xor_si128(s[0][vector], s[3][vector]);
+      s[2][vector] = _mm_xor_si128(s[2][vector], t);
+      s[3][vector] = rotate_left(s[3][vector], 45);
+    }
+  }
+
+  // g_lanes words with each bit set with probability density / 2^16, a
+  // uniform word is ored in for every set bit of density and anded in for
+  // every clear one, lowest first (from the lowest set bit, as the clear
+  // bits below it would only and into zero)
+  void density_words(
+    lanes_t& rng, const uint32_t density, uint64_t (&words)[g_lanes]) {
+    if (density == 0 || density >= 1u << g_density_bits) {
+      std::fill_n(words, g_lanes, density == 0 ? 0 : ~uint64_t(0));
+      return;
+    }
+    lanes_t state = rng;
+    __m128i result[g_vectors];
+    __m128i random[g_vectors];
+    next_lanes(state, result);
+    for (int32_t bit = std::countr_zero(density) + 1; bit < g_density_bits;
+         bit++) {
+      next_lanes(state, random);
+      for (int32_t vector = 0; vector < g_vectors; vector++) {
+        result[vector] = ((density >> bit) & 1) != 0
+                         ? _mm_or_si128(result[vector], random[vector])
+                         : _mm_and_si128(result[vector], random[vector]);
+      }
+    }
+    rng = state;
+    for (int32_t vector = 0; vector < g_vectors; vector++) {
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(words + vector * 2), result[vector]);
+    }
+  }
+#else
+  // as above, a lane at a time
+  struct lanes_t {
+    uint64_t s_[4][g_lanes];
+  };
+
+  lanes_t make_lanes(uint64_t seed) {
+    lanes_t rng;
+    for (int32_t lane = 0; lane < g_lanes; lane++) {
+      for (int32_t i = 0; i < 4; i++) {
+        rng.s_[i][lane] = splitmix64(seed);
+      }
+    }
+    return rng;
+  }
+
+  void density_words(
+    lanes_t& rng, const uint32_t density, uint64_t (&words)[g_lanes]) {
+    if (density == 0 || density >= 1u << g_density_bits) {
+      std::fill_n(words, g_lanes, density == 0 ? 0 : ~uint64_t(0));
+      return;
+    }
+    for (int32_t lane = 0; lane < g_lanes; lane++) {
+      xoshiro256_t lane_rng;
+      for (int32_t i = 0; i < 4; i++) {
+        lane_rng.s_[i] = rng.s_[i][lane];
+      }
+      uint64_t result = xoshiro256_next(lane_rng);
+      for (int32_t bit = std::countr_zero(density) + 1; bit < g_density_bits;
+           bit++) {
+        const uint64_t random = xoshiro256_next(lane_rng);
+        result = ((density >> bit) & 1) != 0 ? result | random
+                                             : result & random;
+      }
+      for (int32_t i = 0; i < 4; i++) {
+        rng.s_[i][lane] = lane_rng.s_[i];
+      }
+      words[lane] = result;
+    }
+  }
+#endif
+
+} // namespace
+
+void fill_soup(
+  bitboard_t& board, const int32_t x, const int32_t y, const int32_t width,
+  const int32_t height, const soup_options_t& options) {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  const auto density = uint32_t(std::lround(
+    std::clamp(options.density_, 0.0, 1.0) * (1 << g_density_bits)));
+  const int32_t first = x >> 6;
+  const int32_t last = (x + width - 1) >> 6;
+  const int64_t row_words = last - first + 1;
+  const uint64_t first_mask = ~uint64_t(0) << (x & 63);
+  const uint64_t last_mask = ~uint64_t(0) >> (63 - ((x + width - 1) & 63));
+  const int64_t words = row_words * height;
+  const int64_t chunks = (words + g_chunk_words - 1) / g_chunk_words;
+
+  std::atomic<int64_t> next_chunk = 0;
+  const auto worker = [&] {
+    uint64_t random[g_lanes];
+    for (int64_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+      lanes_t rng =
+        make_lanes(options.seed_ ^ (uint64_t(chunk) * 0x9e3779b97f4a7c15));
+      const int64_t begin = chunk * g_chunk_words;
+      const int64_t end = std::min(begin + g_chunk_words, words);
+      int64_t row = begin / row_words;
+      int64_t word = begin % row_words;
+      for (int64_t index = begin; index < end; index += g_lanes) {
+        density_words(rng, density, random);
+        for (int64_t lane = 0; lane < g_lanes && index + lane < end; lane++) {
+          uint64_t mask = ~uint64_t(0);
+          if (word == 0) {
+            mask &= first_mask;
+          }
+          if (word == row_words - 1) {
+            mask &= last_mask;
+          }
+          uint64_t& cells =
+            board.words_[(y + row) * board.stride_ + first + word];
+          cells = (cells & ~mask) | (random[lane] & mask);
+          if (++word == row_words) {
+            word = 0;
+            row++;
+          }
+        }
+      }
+    }
+  };
+
+  const int32_t thread_count = int32_t(std::min<int64_t>(
+    options.threads_ > 0
+      ? options.threads_
+      : std::max(int32_t(std::thread::hardware_concurrency()), 1),
+    chunks));
+  std::vector<std::thread> threads;
+  for (int32_t thread = 1; thread < thread_count; thread++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "bitboard.h"
+
+#include <cstdint>
+
+struct soup_options_t {
+  double density_ = 0.5; // chance of each cell being alive, to 1/65536
+  uint64_t seed_ = 1;
+  int32_t threads_ = 0; // 0 to use every core
+};
+
+// fills the width x height region with its top left cell at (x, y) (which
+// must lie on the board) with random cells, the cells around it are kept.
+// whole words are drawn from xoshiro256** generators run side by side and
+// combined a bit of the density at a time, the same seed and region give the
+// same cells whatever the thread count
+void fill_soup(
+  bitboard_t& board, int32_t x, int32_t y, int32_t width, int32_t height,
+  const soup_options_t& options);
+
+inline void fill_soup(bitboard_t& board, const soup_options_t& options) {
+  fill_soup(board, 0, 0, board.width_, board.height_, options);
+}
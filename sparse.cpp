@@ -0,0 +1,145 @@
+#include "sparse.h"
+
+#include <algorithm>
+
+namespace {
+
+  constexpr uint8_t g_alive = 0x10;
+  constexpr uint8_t g_count = 0x0f;
+
+  // the cell (x, y) joins to when it's off the board, the same mapping
+  // fill_halo uses (rows first, then the sides of the row landed on), false
+  // if it's dead space on the plane
+  bool join_cell(const sparse_board_t& board, int64_t& x, int64_t& y) {
+    const int64_t width = board.width_;
+    const int64_t height = board.height_;
+    if (y < 0 || y >= height) {
+      if (board.topology_ == topology_e::plane) {
+        return false;
+      }
+      y = y < 0 ? y + height : y - height;
+      if (board.topology_ != topology_e::torus) {
+        x = width - 1 - x;
+      }
+    }
+    if (x < 0 || x >= width) {
+      if (board.topology_ == topology_e::plane) {
+        return false;
+      }
+      x = x < 0 ? x + width : x - width;
+      if (board.topology_ == topology_e::cross_surface) {
+        y = height - 1 - y;
+      }
+    }
+    return true;
+  }
+
+  // keys of the (up to 8) neighbours of a cell, repeated where the edges
+  // joining make a cell neighbour another more than once
+  int32_t neighbours(
+    const sparse_board_t& board, const uint64_t key, uint64_t (&keys)[8]) {
+    const int64_t x = sparse_key_x(key);
+    const int64_t y = sparse_key_y(key);
+    int32_t count = 0;
+    for (int64_t dy = -1; dy <= 1; dy++) {
+      for (int64_t dx = -1; dx <= 1; dx++) {
+        int64_t nx = x + dx;
+        int64_t ny = y + dy;
+        if ((dx != 0 || dy != 0) && join_cell(board, nx, ny)) {
+          keys[count++] = sparse_key(int32_t(nx), int32_t(ny));
+        }
+      }
+    }
+    return count;
+  }
+
+  // flips a cell and moves the neighbour counts around it
+  void flip_cell(sparse_board_t& board, const uint64_t key) {
+    const bool alive = (board.cells_[key] ^= g_alive) & g_alive;
+    if (!alive && board.cells_[key] == 0) {
+      board.cells_.erase(key);
+    }
+    board.population_ += alive ? 1 : -1;
+    uint64_t keys[8];
+    const int32_t count = neighbours(board, key, keys);
+    for (int32_t i = 0; i < count; i++) {
+      if (alive) {
+        board.cells_[keys[i]]++;
+      } else if (const auto cell = board.cells_.find(keys[i]);
+                 --cell->second == 0) {
+        board.cells_.erase(cell);
+      }
+    }
+  }
+
+} // namespace
+
+sparse_board_t make_sparse_board(
+  const int32_t width, const int32_t height, const topology_e topology) {
+  sparse_board_t board;
+  board.width_ = width;
+  board.height_ = height;
+  board.topology_ = topology;
+  return board;
+}
+
+bool sparse_cell(
+  const sparse_board_t& board, const int32_t x, const int32_t y) {
+  const auto cell = board.cells_.find(sparse_key(x, y));
+  return cell != board.cells_.end() && (cell->second & g_alive) != 0;
+}
+
+void set_sparse_cell(
+  sparse_board_t& board, const int32_t x, const int32_t y, const bool alive) {
+  if (sparse_cell(board, x, y) != alive) {
+    flip_cell(board, sparse_key(x, y));
+    board.changed_.push_back(sparse_key(x, y));
+  }
+}
+
+void step_sparse(sparse_board_t& board) {
+  // only cells next to a change can change
+  std::vector<uint64_t> candidates;
+  candidates.reserve(board.changed_.size() * 9);
+  for (const uint64_t key : board.changed_) {
+    uint64_t keys[8];
+    const int32_t count = neighbours(board, key, keys);
+    candidates.push_back(key);
+    candidates.insert(candidates.end(), keys, keys + count);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(
+    std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  board.changed_.clear();
+  for (const uint64_t key : candidates) {
+    const auto cell = board.cells_.find(key);
+    const uint8_t state = cell == board.cells_.end() ? 0 : cell->second;
+    const uint8_t count = state & g_count;
+    const bool alive = (state & g_alive) != 0;
+    if ((count == 3 || (count == 2 && alive)) != alive) {
+      board.changed_.push_back(key);
+    }
+  }
+  // every cell is decided before any counts move
+  for (const uint64_t key : board.changed_) {
+    flip_cell(board, key);
+  }
+}
+
+uint64_t sparse_hash(const sparse_board_t& board) {
+  std::vector<uint64_t> live;
+  live.reserve(board.population_);
+  for (const auto& [key, state] : board.cells_) {
+    if ((state & g_alive) != 0) {
+      live.push_back(key);
+    }
+  }
+  std::sort(live.begin(), live.end());
+  uint64_t hash = 0xcbf29ce484222325;
+  for (const uint64_t key : live) {
+    hash = (hash ^ key) * 0x9e3779b97f4a7c15;
+    hash ^= hash >> 32;
+  }
+  return hash;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "topology.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// a board of any size (up to 2^31 - 1 cells a side) stored as the cells next to
+// a live cell, keyed by sparse_key, a generation only looks at the cells that
+// changed in the one before and their neighbours so it costs O(changes)
+// instead of O(area)
+struct sparse_board_t {
+  int32_t width_ = 0;
+  int32_t height_ = 0;
+  topology_e topology_ = topology_e::torus;
+  int64_t population_ = 0;
+  // bit 4 is set for a live cell, bits 0-3 count its live neighbours, cells
+  // that are dead with no live neighbours aren't stored
+  std::unordered_map<uint64_t, uint8_t> cells_;
+  std::vector<uint64_t> changed_; // flipped by the last step or since
+};
+
+inline uint64_t sparse_key(int32_t x, int32_t y) {
+  return uint64_t(uint32_t(y)) << 32 | uint32_t(x);
+}
+
+inline int32_t sparse_key_x(uint64_t key) {
+  return int32_t(uint32_t(key));
+}
+
+inline int32_t sparse_key_y(uint64_t key) {
+  return int32_t(uint32_t(key >> 32));
+}
+
+sparse_board_t make_sparse_board(
+  int32_t width, int32_t height, topology_e topology);
+
+bool sparse_cell(const sparse_board_t& board, int32_t x, int32_t y);
+void set_sparse_cell(sparse_board_t& board, int32_t x, int32_t y, bool alive);
+
+// advances one generation, changed_ is left holding the cells that flipped
+void step_sparse(sparse_board_t& board);
+
+// of the live cells, independent of the order they were added in
+uint64_t sparse_hash(const sparse_board_t& board);
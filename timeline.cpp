@@ -0,0 +1,236 @@
+#include "timeline.h"
+#include "delta.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+  constexpr char g_magic[4] = {'G', 'O', 'L', 'T'};
+  constexpr char g_index_magic[4] = {'G', 'O', 'L', 'I'};
+  constexpr uint8_t g_version = 1;
+  constexpr size_t g_footer_size = 8 + 8 + sizeof(g_index_magic);
+  constexpr uint64_t g_header_size = sizeof(g_magic) + 1 + 4 + 4 + 4;
+  constexpr uint64_t g_record_header_size = 1 + 4;
+  // boards are held whole, 512MB is far beyond anything the window steps
+  constexpr int64_t g_max_cells = int64_t(1) << 32;
+
+  enum class record_e : uint8_t { delta, keyframe };
+
+  template<typename T>
+  void write_fixed(std::ofstream& file, const T value) {
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); i++) {
+      bytes[i] = char(value >> (i * 8));
+    }
+    file.write(bytes, sizeof(T));
+  }
+
+  template<typename T>
+  T read_fixed(std::ifstream& file) {
+    uint8_t bytes[sizeof(T)] = {};
+    file.read(reinterpret_cast<char*>(bytes), sizeof(T));
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+      value |= T(bytes[i]) << (i * 8);
+    }
+    return value;
+  }
+
+  void write_generations(
+    timeline_writer_t& writer, const bitboard_t& layout) {
+    std::vector<uint64_t> previous(layout.words_.size());
+    const std::vector<uint64_t> empty(layout.words_.size());
+    while (auto words = writer.pending_.pop()) {
+      const bool keyframe =
+        writer.generations_ % writer.keyframe_interval_ == 0;
+      if (keyframe) {
+        writer.index_.push_back(uint64_t(writer.file_.tellp()));
+      }
+      const std::vector<uint8_t> payload =
+        encode_delta(keyframe ? empty : previous, *words);
+      writer.file_.put(char(keyframe ? record_e::keyframe : record_e::delta));
+      write_fixed(writer.file_, uint32_t(payload.size()));
+      writer.file_.write(
+        reinterpret_cast<const char*>(payload.data()), payload.size());
+      writer.generations_++;
+      std::copy(words->begin(), words->end(), previous.begin());
+      writer.free_.push(std::move(*words));
+    }
+  }
+
+  // reads the record of generation into payload_, false if its type or
+  // offset don't match the index, it runs past the records or its delta
+  // reaches past the board
+  bool read_record(timeline_reader_t& reader, const int64_t generation) {
+    const auto offset = uint64_t(reader.file_.tellg());
+    const bool keyframe = generation % reader.keyframe_interval_ == 0;
+    const auto type = record_e(reader.file_.get());
+    const auto size = read_fixed<uint32_t>(reader.file_);
+    if (
+      !reader.file_
+      || type != (keyframe ? record_e::keyframe : record_e::delta)
+      || (keyframe
+          && offset != reader.index_[generation / reader.keyframe_interval_])
+      || offset + g_record_header_size > reader.end_
+      || size > reader.end_ - offset - g_record_header_size) {
+      return false;
+    }
+    reader.payload_.resize(size);
+    reader.file_.read(reinterpret_cast<char*>(reader.payload_.data()), size);
+    return reader.file_
+        && check_delta(
+             reader.payload_.data(), size, reader.board_.words_.size());
+  }
+
+} // namespace
+
+bool begin_timeline(
+  timeline_writer_t& writer, const char* path, const bitboard_t& board,
+  const int32_t keyframe_interval) {
+  writer.file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!writer.file_) {
+    return false;
+  }
+  writer.keyframe_interval_ = keyframe_interval;
+  writer.file_.write(g_magic, sizeof(g_magic));
+  writer.file_.put(char(g_version));
+  write_fixed(writer.file_, uint32_t(board.width_));
+  write_fixed(writer.file_, uint32_t(board.height_));
+  write_fixed(writer.file_, uint32_t(keyframe_interval));
+  // the file belongs to the writer thread once it starts
+  if (!writer.file_) {
+    writer.file_.close();
+    return false;
+  }
+  for (int32_t i = 0; i < 32; i++) {
+    writer.free_.push(std::vector<uint64_t>(board.words_.size()));
+  }
+  writer.thread_ = std::thread(
+    [&writer, layout = make_bitboard(board.width_, board.height_)] {
+      write_generations(writer, layout);
+    });
+  return true;
+}
+
+void push_timeline(timeline_writer_t& writer, const bitboard_t& board) {
+  if (auto words = writer.free_.pop()) {
+    std::copy(board.words_.begin(), board.words_.end(), words->begin());
+    writer.pending_.push(std::move(*words));
+  }
+}
+
+bool end_timeline(timeline_writer_t& writer) {
+  writer.pending_.close();
+  if (writer.thread_.joinable()) {
+    writer.thread_.join();
+  }
+  writer.free_.close();
+  for (const uint64_t offset : writer.index_) {
+    write_fixed(writer.file_, offset);
+  }
+  write_fixed(writer.file_, uint64_t(writer.index_.size()));
+  write_fixed(writer.file_, uint64_t(writer.generations_));
+  writer.file_.write(g_index_magic, sizeof(g_index_magic));
+  const bool written = bool(writer.file_);
+  writer.file_.close();
+  return written;
+}
+
+bool open_timeline(timeline_reader_t& reader, const char* path) {
+  reader.file_.open(path, std::ios::binary);
+  char magic[sizeof(g_magic)] = {};
+  reader.file_.read(magic, sizeof(magic));
+  if (
+    !reader.file_ || std::memcmp(magic, g_magic, sizeof(g_magic)) != 0
+    || reader.file_.get() != g_version) {
+    return false;
+  }
+  const auto width = int32_t(read_fixed<uint32_t>(reader.file_));
+  const auto height = int32_t(read_fixed<uint32_t>(reader.file_));
+  reader.keyframe_interval_ = int32_t(read_fixed<uint32_t>(reader.file_));
+  if (
+    !reader.file_ || width <= 0 || height <= 0
+    || int64_t(width) * height > g_max_cells
+    || reader.keyframe_interval_ <= 0) {
+    return false;
+  }
+
+  reader.file_.seekg(0, std::ios::end);
+  const auto file_size = uint64_t(reader.file_.tellg());
+  if (!reader.file_ || file_size < g_header_size + g_footer_size) {
+    return false;
+  }
+  reader.file_.seekg(-std::streamoff(g_footer_size), std::ios::end);
+  const auto keyframes = read_fixed<uint64_t>(reader.file_);
+  const auto generations = read_fixed<uint64_t>(reader.file_);
+  char index_magic[sizeof(g_index_magic)] = {};
+  reader.file_.read(index_magic, sizeof(index_magic));
+  // a keyframe starts every keyframe_interval_ generations
+  const uint64_t interval = uint64_t(reader.keyframe_interval_);
+  if (
+    !reader.file_
+    || std::memcmp(index_magic, g_index_magic, sizeof(g_index_magic)) != 0
+    || generations == 0 || generations > uint64_t(INT64_MAX)
+    || keyframes != (generations - 1) / interval + 1
+    || keyframes > (file_size - g_header_size - g_footer_size) / 8) {
+    return false;
+  }
+  reader.generations_ = int64_t(generations);
+  reader.end_ = file_size - g_footer_size - keyframes * 8;
+  reader.file_.seekg(std::streamoff(reader.end_));
+  reader.index_.resize(keyframes);
+  uint64_t previous = 0;
+  for (uint64_t& offset : reader.index_) {
+    offset = read_fixed<uint64_t>(reader.file_);
+    if (offset < std::max(g_header_size, previous) || offset >= reader.end_) {
+      return false;
+    }
+    previous = offset + g_record_header_size;
+  }
+  if (!reader.file_) {
+    return false;
+  }
+  reader.board_ = make_bitboard(width, height);
+  reader.generation_ = -1;
+  seek_timeline(reader, 0);
+  return reader.generation_ == 0;
+}
+
+const bitboard_t& seek_timeline(
+  timeline_reader_t& reader, int64_t generation) {
+  generation = std::clamp(generation, int64_t(0), reader.generations_ - 1);
+  const int64_t keyframe = generation / reader.keyframe_interval_;
+  const int64_t from_generation = reader.generation_;
+  const std::streamoff from_offset = reader.file_.tellg();
+  const int64_t keyframe_generation = keyframe * reader.keyframe_interval_;
+  bool jumped = false;
+  if (
+    generation < reader.generation_ || reader.generation_ < 0
+    || keyframe > reader.generation_ / reader.keyframe_interval_) {
+    reader.file_.seekg(std::streamoff(reader.index_[keyframe]));
+    reader.generation_ = keyframe_generation - 1;
+    jumped = true;
+  }
+  while (reader.generation_ < generation) {
+    const std::streamoff offset = reader.file_.tellg();
+    if (!read_record(reader, reader.generation_ + 1)) {
+      // the board is untouched until the keyframe jumped to is read
+      reader.file_.clear();
+      if (jumped && reader.generation_ < keyframe_generation) {
+        reader.generation_ = from_generation;
+        reader.file_.seekg(from_offset);
+      } else {
+        reader.file_.seekg(offset);
+      }
+      break;
+    }
+    if ((reader.generation_ + 1) % reader.keyframe_interval_ == 0) {
+      clear_bitboard(reader.board_);
+    }
+    apply_delta(reader.board_.words_, reader.payload_);
+    reader.generation_++;
+  }
+  return reader.board_;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "bitboard.h"
+#include "bounded_queue.h"
+
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+// long runs streamed to disk with one record per generation holding the
+// delta from the previous generation, a full keyframe every
+// keyframe_interval generations and a footer index of keyframe offsets
+//
+// layout: "GOLT", version (u8), width, height, keyframe interval (u32), then
+// records of type (u8), payload size (u32) and an encode_delta payload
+// (keyframes are encoded against an empty board), then the footer of keyframe
+// offsets (u64 each), keyframe count, generation count (u64) and "GOLI"
+
+// encodes and writes generations on its own thread so the simulation only
+// pays for copying the board into a recycled buffer
+struct timeline_writer_t {
+  std::ofstream file_;
+  std::thread thread_;
+  bounded_queue_t<std::vector<uint64_t>> pending_{32};
+  bounded_queue_t<std::vector<uint64_t>> free_{32};
+  std::vector<uint64_t> index_;
+  int64_t generations_ = 0;
+  int32_t keyframe_interval_ = 0;
+};
+
+bool begin_timeline(
+  timeline_writer_t& writer, const char* path, const bitboard_t& board,
+  int32_t keyframe_interval = 1024);
+// queues the next generation, only waits if the writer thread falls behind
+void push_timeline(timeline_writer_t& writer, const bitboard_t& board);
+// flushes outstanding generations and writes the footer index
+bool end_timeline(timeline_writer_t& writer);
+
+struct timeline_reader_t {
+  std::ifstream file_;
+  std::vector<uint64_t> index_;
+  uint64_t end_ = 0; // offset the records stop at (where the index starts)
+  std::vector<uint8_t> payload_;
+  bitboard_t board_; // state at generation_
+  int64_t generation_ = -1;
+  int64_t generations_ = 0;
+  int32_t keyframe_interval_ = 0;
+};
+
+// checks the header and footer index and loads the first generation
+bool open_timeline(timeline_reader_t& reader, const char* path);
+// loads the nearest keyframe at or before generation (unless reading on from
+// the current generation is closer) and applies deltas up to it. a record
+// that doesn't match the index or reaches past the board stops the seek at
+// the last generation read (in generation_), or where it started
+const bitboard_t& seek_timeline(timeline_reader_t& reader, int64_t generation);
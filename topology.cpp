@@ -0,0 +1,106 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+  bool padded_bit(const uint64_t* row, const int32_t bit) {
+    return (row[bit >> 6] >> (bit & 63)) & 1;
+  }
+
+  void set_padded_bit(uint64_t* row, const int32_t bit, const bool alive) {
+    row[bit >> 6] |= uint64_t(alive) << (bit & 63);
+  }
+
+  // writes the ghost row from a padded row of the board, mirrored or straight
+  void fill_ghost_row(
+    halo_board_t& halo, const int32_t ghost, const int32_t source,
+    const bool mirrored) {
+    uint64_t* row = halo.words_.data() + ghost * halo.stride_;
+    const uint64_t* from = halo_row(halo, source);
+    if (!mirrored) {
+      std::copy(from, from + halo.stride_, row);
+      return;
+    }
+    const int32_t last = halo.width_ + 1;
+    for (int32_t bit = 0; bit <= last; bit++) {
+      set_padded_bit(row, bit, padded_bit(from, last - bit));
+    }
+  }
+
+} // namespace
+
+const char* topology_name(const topology_e topology) {
+  switch (topology) {
+    case topology_e::plane:
+      return "Plane";
+    case topology_e::torus:
+      return "Torus";
+    case topology_e::klein_bottle:
+      return "Klein bottle";
+    case topology_e::cross_surface:
+      return "Cross-surface";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* topology_id(const topology_e topology) {
+  switch (topology) {
+    case topology_e::plane:
+      return "plane";
+    case topology_e::torus:
+      return "torus";
+    case topology_e::klein_bottle:
+      return "klein";
+    case topology_e::cross_surface:
+      return "cross";
+    default:
+      return "unknown";
+  }
+}
+
+bool find_topology(const char* id, topology_e& topology) {
+  for (int32_t kind = 0; kind < static_cast<int32_t>(topology_e::count);
+       kind++) {
+    if (std::strcmp(id, topology_id(static_cast<topology_e>(kind))) == 0) {
+      topology = static_cast<topology_e>(kind);
+      return true;
+    }
+  }
+  return false;
+}
+
+void fill_halo(
+  halo_board_t& halo, const bitboard_t& board, const topology_e topology) {
+  const int32_t width = board.width_;
+  const int32_t height = board.height_;
+  halo.width_ = width;
+  halo.height_ = height;
+  halo.stride_ = board.stride_ + 1;
+  halo.words_.assign(size_t(halo.stride_) * (height + 3), uint64_t(0));
+
+  const bool mirror_sides = topology == topology_e::cross_surface;
+  for (int32_t y = 0; y < height; y++) {
+    const uint64_t* from = board.words_.data() + y * board.stride_;
+    uint64_t* row = halo.words_.data() + (y + 1) * halo.stride_;
+    uint64_t carry = 0;
+    for (int32_t word = 0; word < board.stride_; word++) {
+      row[word] = (from[word] << 1) | carry;
+      carry = from[word] >> 63;
+    }
+    row[board.stride_] = carry;
+    if (topology != topology_e::plane) {
+      const int32_t side = mirror_sides ? height - 1 - y : y;
+      set_padded_bit(row, 0, bitboard_cell(board, width - 1, side));
+      set_padded_bit(row, width + 1, bitboard_cell(board, 0, side));
+    }
+  }
+
+  if (topology != topology_e::plane) {
+    const bool mirror_ends = topology != topology_e::torus;
+    fill_ghost_row(halo, 0, height, mirror_ends);
+    fill_ghost_row(halo, height + 1, 1, mirror_ends);
+  }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "bitboard.h"
+
+#include <cstdint>
+#include <vector>
+
+// how the edges of the board join up
+enum class topology_e {
+  plane, // everything past the edges is dead
+  torus, // left joins right, top joins bottom
+  klein_bottle, // as the torus but top and bottom join mirrored left to right
+  cross_surface, // both pairs of edges join mirrored (real projective plane)
+  count
+};
+
+const char* topology_name(topology_e topology);
+const char* topology_id(topology_e topology); // command line name
+
+// looks up a topology by topology_id, false if there is no such topology
+bool find_topology(const char* id, topology_e& topology);
+
+// a board copied with a one cell ghost halo on every side, so a kernel never
+// checks for edges: bit x + 1 of padded row y + 1 holds cell (x, y)
+// rows are stride_ words (one more than the board) and a spare zero row
+// follows the bottom halo for kernels that read rows in pairs
+struct halo_board_t {
+  int32_t width_ = 0; // of the board (not counting the halo)
+  int32_t height_ = 0;
+  int32_t stride_ = 0;
+  std::vector<uint64_t> words_;
+};
+
+inline const uint64_t* halo_row(const halo_board_t& halo, int32_t padded_y) {
+  return halo.words_.data() + padded_y * halo.stride_;
+}
+
+// copies board into halo and fills the ghost cells with the cells they join
+// to, corners are a mirrored (or straight for the torus) copy of the far row
+// including its own ghosts
+void fill_halo(
+  halo_board_t& halo, const bitboard_t& board, topology_e topology);
@@ -0,0 +1,270 @@
+#include "verify.h"
+#include "batch.h"
+#include "blocked.h"
+#include "fixed_board.h"
+#include "pattern.h"
+#include "soup.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+namespace {
+
+  // step_blocked is checked at each of these depths, with tiles small enough
+  // that a 96x96 board is split into many (on one thread, a pass of a board
+  // this small takes less than starting the others would)
+  constexpr std::array<int32_t, 5> blocked_depths = {1, 2, 3, 5, 8};
+  constexpr int32_t blocked_tile_rows = 7;
+
+  // each case is put in this many step_batch lanes, so the boards span
+  // several groups and are packed into fewer as they settle
+  constexpr int32_t batch_copies = 3;
+
+  struct verify_case_t {
+    std::string name_;
+    bitboard_t board_;
+  };
+
+  std::vector<verify_case_t> build_cases(
+    const verify_options_t& options, const int32_t width,
+    const int32_t height) {
+    std::vector<verify_case_t> cases;
+    for (const stamp_t& stamp : stamp_library()) {
+      const bitboard_t& pattern = stamp.orientations_[0];
+      bitboard_t board = make_bitboard(width, height);
+      blit_bitboard(
+        board, pattern, (board.width_ - pattern.width_) / 2,
+        (board.height_ - pattern.height_) / 2);
+      cases.push_back({stamp.name_, std::move(board)});
+    }
+    for (int32_t soup = 0; soup < options.soups_; soup++) {
+      bitboard_t board = make_bitboard(width, height);
+      fill_soup(
+        board, {.density_ = options.density_,
+                .seed_ = options.seed_ + uint64_t(soup),
+                .threads_ = 1});
+      cases.push_back({"Soup " + std::to_string(soup + 1), std::move(board)});
+    }
+    return cases;
+  }
+
+  // the generation of each hash run_hashes returns, interval_ apart and then
+  // the last generation
+  int64_t checked_generation(
+    const verify_options_t& options, const size_t check) {
+    return std::min<int64_t>(
+      int64_t(check) * options.interval_, options.generations_);
+  }
+
+  // board hashes after 0, interval_, 2 * interval_... generations and after
+  // the last, step advances board by the generations it's given
+  template<typename step_t>
+  std::vector<uint64_t> run_hashes(
+    const verify_options_t& options, bitboard_t& board, const step_t& step) {
+    std::vector<uint64_t> hashes = {bitboard_hash(board)};
+    for (int32_t generation = 0; generation < options.generations_;) {
+      const int32_t generations =
+        std::min(options.interval_, options.generations_ - generation);
+      step(generations);
+      generation += generations;
+      hashes.push_back(bitboard_hash(board));
+    }
+    return hashes;
+  }
+
+  std::vector<uint64_t> hash_run(
+    const verify_options_t& options, const engine_e kind,
+    const topology_e topology, bitboard_t board) {
+    engine_t engine;
+    engine.kind_ = kind;
+    engine.topology_ = topology;
+    const std::vector<uint64_t> hashes =
+      run_hashes(options, board, [&](const int32_t generations) {
+        for (int32_t generation = 0; generation < generations; generation++) {
+          step_engine(engine, board);
+        }
+      });
+    destroy_engine(engine);
+    return hashes;
+  }
+
+  std::vector<uint64_t> blocked_run(
+    const verify_options_t& options, const int32_t depth,
+    const topology_e topology, bitboard_t board) {
+    const blocked_options_t blocked = {
+      .depth_ = depth, .tile_rows_ = blocked_tile_rows, .threads_ = 1};
+    return run_hashes(options, board, [&](const int32_t generations) {
+      step_blocked(board, topology, generations, blocked);
+    });
+  }
+
+  template<int32_t width, int32_t height, topology_e topology>
+  std::vector<uint64_t> fixed_run(
+    const verify_options_t& options, bitboard_t board) {
+    fixed_board_t<width, height, topology> fixed;
+    fixed_from_bitboard(fixed, board);
+    return run_hashes(options, board, [&](const int32_t generations) {
+      for (int32_t generation = 0; generation < generations; generation++) {
+        step_fixed(fixed);
+      }
+      board = fixed_to_bitboard(fixed);
+    });
+  }
+
+  template<int32_t width, int32_t height>
+  std::vector<uint64_t> fixed_run(
+    const verify_options_t& options, const topology_e topology,
+    const bitboard_t& board) {
+    switch (topology) {
+      case topology_e::plane:
+        return fixed_run<width, height, topology_e::plane>(options, board);
+      case topology_e::torus:
+        return fixed_run<width, height, topology_e::torus>(options, board);
+      case topology_e::klein_bottle:
+        return fixed_run<width, height, topology_e::klein_bottle>(
+          options, board);
+      case topology_e::cross_surface:
+        return fixed_run<width, height, topology_e::cross_surface>(
+          options, board);
+      default:
+        return {};
+    }
+  }
+
+  // the engine mc_gol_update_board where it supports the topology, otherwise
+  // the lookup table engine
+  engine_e checked_against(const topology_e topology) {
+    return engine_supports(engine_e::reference, topology) ? engine_e::reference
+                                                          : engine_e::lut;
+  }
+
+  // records the first hash of a run that differs from the expected run
+  void check_run(
+    verify_result_t& result, const verify_options_t& options,
+    std::string name, const topology_e topology, const std::string& case_name,
+    const std::vector<uint64_t>& expected,
+    const std::vector<uint64_t>& hashes) {
+    result.runs_++;
+    for (size_t check = 0; check < expected.size(); check++) {
+      if (check >= hashes.size() || hashes[check] != expected[check]) {
+        result.mismatches_.push_back(
+          {.name_ = std::move(name),
+           .against_ = checked_against(topology),
+           .topology_ = topology,
+           .case_ = case_name,
+           .generation_ = checked_generation(options, check)});
+        return;
+      }
+    }
+  }
+
+  // every case in batch_copies lanes of one batch, only the final boards are
+  // compared as step_batch doesn't stop part way
+  void verify_batch(
+    verify_result_t& result, const verify_options_t& options,
+    const topology_e topology, const std::vector<verify_case_t>& cases,
+    const std::vector<uint64_t>& finals) {
+    const auto count = int32_t(cases.size());
+    batch_t batch = make_batch(
+      options.board_size_, options.board_size_, count * batch_copies);
+    for (int32_t board = 0; board < batch.count_; board++) {
+      set_batch_board(batch, board, cases[board % count].board_);
+    }
+    step_batch(
+      batch, {.generations_ = options.generations_,
+              .topology_ = topology,
+              .threads_ = 0});
+    for (int32_t board = 0; board < batch.count_; board++) {
+      result.runs_++;
+      if (
+        bitboard_hash(batch_board(batch, board)) != finals[board % count]) {
+        result.mismatches_.push_back(
+          {.name_ = "step_batch lane " + std::to_string(board),
+           .against_ = checked_against(topology),
+           .topology_ = topology,
+           .case_ = cases[board % count].name_,
+           .generation_ = options.generations_});
+      }
+    }
+  }
+
+  template<int32_t width, int32_t height>
+  void verify_fixed(
+    verify_result_t& result, const verify_options_t& options,
+    const topology_e topology) {
+    const std::string name = "fixed_board_t " + std::to_string(width) + "x"
+                           + std::to_string(height);
+    for (const verify_case_t& verify_case :
+         build_cases(options, width, height)) {
+      check_run(
+        result, options, name, topology, verify_case.name_,
+        hash_run(
+          options, checked_against(topology), topology, verify_case.board_),
+        fixed_run<width, height>(options, topology, verify_case.board_));
+    }
+  }
+
+} // namespace
+
+verify_result_t run_verify(const verify_options_t& options) {
+  verify_result_t result;
+  const std::vector<verify_case_t> cases =
+    build_cases(options, options.board_size_, options.board_size_);
+  for (int32_t topology_kind = 0;
+       topology_kind < static_cast<int32_t>(topology_e::count);
+       topology_kind++) {
+    const auto topology = static_cast<topology_e>(topology_kind);
+    const engine_e against = checked_against(topology);
+    std::vector<uint64_t> finals;
+    for (const verify_case_t& verify_case : cases) {
+      const std::vector<uint64_t> expected =
+        hash_run(options, against, topology, verify_case.board_);
+      finals.push_back(expected.back());
+      for (int32_t kind = 0; kind < static_cast<int32_t>(engine_e::count);
+           kind++) {
+        const auto engine = static_cast<engine_e>(kind);
+        if (engine == against || !engine_supports(engine, topology)) {
+          continue;
+        }
+        check_run(
+          result, options, engine_name(engine), topology, verify_case.name_,
+          expected, hash_run(options, engine, topology, verify_case.board_));
+      }
+      for (const int32_t depth : blocked_depths) {
+        check_run(
+          result, options, "step_blocked depth " + std::to_string(depth),
+          topology, verify_case.name_, expected,
+          blocked_run(options, depth, topology, verify_case.board_));
+      }
+    }
+    verify_batch(result, options, topology, cases, finals);
+    // the window's size, a single partial word a row, and two words a row
+    verify_fixed<40, 27>(result, options, topology);
+    verify_fixed<100, 33>(result, options, topology);
+  }
+  return result;
+}
+
+bool load_baselines(
+  const char* path, std::map<std::string, double>& baselines) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  std::string id;
+  double rate = 0.0;
+  while (file >> id >> rate) {
+    baselines[id] = rate;
+  }
+  return file.eof();
+}
+
+bool save_baselines(
+  const char* path, const std::map<std::string, double>& baselines) {
+  std::ofstream file(path, std::ios::trunc);
+  for (const auto& [id, rate] : baselines) {
+    file << id << ' ' << rate << '\n';
+  }
+  return bool(file);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "engine.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct verify_options_t {
+  int32_t generations_ = 1000;
+  int32_t interval_ = 16; // board hashes are compared every interval_
+  int32_t board_size_ = 96;
+  int32_t soups_ = 8;
+  double density_ = 0.35;
+  uint64_t seed_ = 1;
+};
+
+// the first generation a board hash differed from the engine it's checked
+// against, mc_gol_update_board where it supports the topology and the lookup
+// table engine (itself checked on the torus) elsewhere
+struct verify_mismatch_t {
+  std::string name_; // engine, fixed_board_t, step_batch lane or step_blocked
+  engine_e against_;
+  topology_e topology_;
+  std::string case_; // pattern name or soup number
+  int64_t generation_ = 0;
+};
+
+struct verify_result_t {
+  int32_t runs_ = 0; // of an engine on a case with a topology
+  std::vector<verify_mismatch_t> mismatches_;
+};
+
+// steps every stamp_library() pattern (centered) and random soups with every
+// engine on every topology it supports, with step_blocked at several depths
+// and all of them at once in step_batch lanes, then again as fixed_board_t
+// boards of two sizes
+verify_result_t run_verify(const verify_options_t& options);
+
+// throughput baselines in Gcells/s by engine_id, one "<id> <rate>" line each
+bool load_baselines(const char* path, std::map<std::string, double>& baselines);
+bool save_baselines(
+  const char* path, const std::map<std::string, double>& baselines);